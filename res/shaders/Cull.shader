@@ -0,0 +1,102 @@
+#shader Compute
+#version 450 core
+
+// One invocation per instance : frustum test of its bounding sphere, then a Hi-Z test
+// against the previous frame's depth pyramid. Visible instances are appended to the
+// range of their draw command and counted in its instanceCount.
+layout(local_size_x = 64) in;
+
+struct Instance {
+    mat4 model;
+    mat4 normal;
+};
+
+struct DrawCommand {
+    uint count;
+    uint instanceCount; // zeroed by the CPU, filled here
+    uint firstIndex;
+    int  baseVertex;
+    uint baseInstance;
+};
+
+layout(std430, binding = 0) writeonly buffer VisibleInstances {
+    Instance visible[];
+};
+layout(std430, binding = 1) readonly buffer InstanceCommands {
+    uint instanceCommand[];
+};
+layout(std430, binding = 2) readonly buffer CommandBounds {
+    vec4 bounds[]; // local bounding sphere of the command's mesh
+};
+layout(std430, binding = 3) buffer Commands {
+    DrawCommand commands[];
+};
+layout(std430, binding = 4) readonly buffer AllInstances {
+    Instance instances[];
+};
+layout(std430, binding = 5) buffer Counters {
+    uint visibleCount;
+};
+
+layout(binding = 15) uniform sampler2D u_hiz;
+
+uniform int u_instanceCount;
+uniform mat4 u_viewProjection;
+uniform vec4 u_planes[6]; // normalized, pointing inside
+uniform bool u_occlusion;
+
+bool isOccluded(vec3 center, float radius)
+{
+    // screen rectangle and nearest depth of the sphere's bounding box
+    vec3 ndcMin = vec3(3.0e38);
+    vec3 ndcMax = vec3(-3.0e38);
+    for (int i = 0; i < 8; i++) {
+        vec3 corner = center + radius * vec3((i & 1) != 0 ? 1.0 : -1.0, (i & 2) != 0 ? 1.0 : -1.0, (i & 4) != 0 ? 1.0 : -1.0);
+        vec4 clip = u_viewProjection * vec4(corner, 1.0);
+        if (clip.w <= 0.0)
+            return false; // crosses the near plane
+        vec3 ndc = clip.xyz / clip.w;
+        ndcMin = min(ndcMin, ndc);
+        ndcMax = max(ndcMax, ndc);
+    }
+    vec2 uvMin = clamp(ndcMin.xy * 0.5 + 0.5, 0.0, 1.0);
+    vec2 uvMax = clamp(ndcMax.xy * 0.5 + 0.5, 0.0, 1.0);
+    float nearest = ndcMin.z * 0.5 + 0.5;
+
+    // the level where the rectangle spans at most 2x2 texels
+    vec2 size = (uvMax - uvMin) * vec2(textureSize(u_hiz, 0));
+    int levels = textureQueryLevels(u_hiz);
+    int level = clamp(int(ceil(log2(max(max(size.x, size.y), 1.0)))), 0, levels - 1);
+
+    ivec2 levelSize = textureSize(u_hiz, level);
+    ivec2 a = clamp(ivec2(uvMin * vec2(levelSize)), ivec2(0), levelSize - 1);
+    ivec2 b = clamp(ivec2(uvMax * vec2(levelSize)), ivec2(0), levelSize - 1);
+    float farthest = max(max(texelFetch(u_hiz, a, level).r, texelFetch(u_hiz, ivec2(b.x, a.y), level).r),
+                         max(texelFetch(u_hiz, ivec2(a.x, b.y), level).r, texelFetch(u_hiz, b, level).r));
+    return nearest > farthest;
+}
+
+void main()
+{
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= uint(u_instanceCount))
+        return;
+
+    uint command = instanceCommand[index];
+    mat4 model = instances[index].model;
+    vec4 sphere = bounds[command];
+    vec3 center = (model * vec4(sphere.xyz, 1.0)).xyz;
+    float scale = max(length(model[0].xyz), max(length(model[1].xyz), length(model[2].xyz)));
+    float radius = sphere.w * scale;
+
+    for (int i = 0; i < 6; i++) {
+        if (dot(u_planes[i].xyz, center) + u_planes[i].w < -radius)
+            return;
+    }
+    if (u_occlusion && isOccluded(center, radius))
+        return;
+
+    uint slot = atomicAdd(commands[command].instanceCount, 1u);
+    visible[commands[command].baseInstance + slot] = instances[index];
+    atomicAdd(visibleCount, 1u);
+}
\ No newline at end of file
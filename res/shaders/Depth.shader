@@ -2,14 +2,26 @@
 #version 450 core
 
 layout(location = 0 ) in vec3 pos;
+layout(location = 5 ) in uint instanceIndex; // baseInstance + gl_InstanceID
 
 uniform mat4 u_projection;
 uniform mat4 u_view;
 uniform mat4 u_model;
 
+// Per-instance data, filled by RenderQueue for its multi-draw indirect calls
+struct Instance {
+    mat4 model;
+    mat4 normal; // normal matrix in the upper-left 3x3
+};
+layout(std430, binding = 0) readonly buffer Instances {
+    Instance instances[];
+};
+uniform bool u_instanced;
+
 void main()
 {
-	gl_Position =u_projection * u_view * u_model * vec4(pos, 1.0);
+	mat4 model = u_instanced ? instances[instanceIndex].model : u_model;
+	gl_Position =u_projection * u_view * model * vec4(pos, 1.0);
 }
 
 #shader Fragment
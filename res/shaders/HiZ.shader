@@ -0,0 +1,48 @@
+#shader Compute
+#version 450 core
+
+// One level of the Hi-Z pyramid : the farthest depth of each 2x2 block of the level
+// above, or, for level 0, a copy of the depth buffer.
+layout(local_size_x = 8, local_size_y = 8) in;
+
+layout(binding = 15) uniform sampler2D u_depth;
+layout(r32f, binding = 0) uniform readonly image2D u_source;
+layout(r32f, binding = 1) uniform writeonly image2D u_destination;
+
+uniform bool u_copyDepth;
+
+float load(ivec2 texel)
+{
+    return imageLoad(u_source, texel).r; // 0 outside the image, never the maximum
+}
+
+void main()
+{
+    ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 size = imageSize(u_destination);
+    if (any(greaterThanEqual(texel, size)))
+        return;
+
+    if (u_copyDepth) {
+        // outside the depth texture counts as far, so nothing is culled against it
+        bool inside = all(lessThan(texel, textureSize(u_depth, 0)));
+        imageStore(u_destination, texel, vec4(inside ? texelFetch(u_depth, texel, 0).r : 1.0));
+        return;
+    }
+
+    ivec2 source = texel * 2;
+    float depth = max(max(load(source), load(source + ivec2(1, 0))), max(load(source + ivec2(0, 1)), load(source + ivec2(1, 1))));
+
+    // odd sizes : the last column / row also covers the texels left over
+    ivec2 sourceSize = imageSize(u_source);
+    bool oddX = (sourceSize.x & 1) != 0 && texel.x == size.x - 1;
+    bool oddY = (sourceSize.y & 1) != 0 && texel.y == size.y - 1;
+    if (oddX)
+        depth = max(depth, max(load(source + ivec2(2, 0)), load(source + ivec2(2, 1))));
+    if (oddY)
+        depth = max(depth, max(load(source + ivec2(0, 2)), load(source + ivec2(1, 2))));
+    if (oddX && oddY)
+        depth = max(depth, load(source + ivec2(2, 2)));
+
+    imageStore(u_destination, texel, vec4(depth));
+}
\ No newline at end of file
@@ -7,6 +7,7 @@ layout(location = 1) in vec2 textcoord;
 layout(location = 2) in vec3 normal;
 layout(location = 3) in vec3 tangent;
 layout(location = 4) in vec3 bitangent;
+layout(location = 5) in uint instanceIndex; // baseInstance + gl_InstanceID
 
 // Outputs to fragment shader
 layout(location = 0) out vec2 TexCoord;
@@ -29,19 +30,37 @@ uniform mat4 u_lightview;
 uniform mat3 u_normalMatrix; 
 uniform vec3 u_viewPos;
 
+// Per-instance data, filled by RenderQueue for its multi-draw indirect calls
+struct Instance {
+    mat4 model;
+    mat4 normal; // normal matrix in the upper-left 3x3
+};
+layout(std430, binding = 0) readonly buffer Instances {
+    Instance instances[];
+};
+uniform bool u_instanced;
+
 
 void main() {
 
-    FragPos = vec3(u_model * vec4(pos, 1.0));
+    mat4 model = u_model;
+    mat3 normalMatrix = u_normalMatrix;
+    if (u_instanced) {
+        Instance instance = instances[instanceIndex];
+        model = instance.model;
+        normalMatrix = mat3(instance.normal);
+    }
+
+    FragPos = vec3(model * vec4(pos, 1.0));
     
-    Normal = normalize(u_normalMatrix * normal);
-    Tangent = normalize(u_normalMatrix * tangent);
-    Bitangent = normalize(u_normalMatrix * bitangent);
+    Normal = normalize(normalMatrix * normal);
+    Tangent = normalize(normalMatrix * tangent);
+    Bitangent = normalize(normalMatrix * bitangent);
     
     TexCoord = textcoord;
     ViewPos = u_viewPos;
     
-    LightSapceFragPos = u_lightprojection * u_lightview * u_model * vec4(pos, 1.0);
+    LightSapceFragPos = u_lightprojection * u_lightview * model * vec4(pos, 1.0);
     gl_Position = u_projection * u_view * vec4(FragPos, 1.0);
 }
 
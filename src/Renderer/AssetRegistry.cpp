@@ -0,0 +1,129 @@
+#include "AssetRegistry.h"
+#include "ecs/Core.h"
+
+void MaterialAsset::bind(const shader& Shader) const
+{
+    if (Shader.getType() != ShaderType::COLORSHADER)
+        return;
+    for (unsigned int i = 0; i < textures.size(); i++)
+    {
+        switch (textures[i]->getType())
+        {
+        case TextureType::DIFFUSE:
+        case TextureType::NORMAL:
+        case TextureType::SPECULAR:
+        case TextureType::HEIGHT:
+        case TextureType::AMBIENT:
+            textures[i]->Bind(i);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+AssetRegistry& AssetRegistry::get()
+{
+    static AssetRegistry instance;
+    return instance;
+}
+
+namespace
+{
+    // Puts value in a free slot (or a new one) and returns its handle under the slot's
+    // current generation. Generations outlive the slots, so they survive clear().
+    template <typename T>
+    uint32_t addToSlot(std::vector<std::optional<T>>& slots, std::vector<uint32_t>& freeSlots, std::vector<uint32_t>& generations, T&& value)
+    {
+        uint32_t index;
+        if (!freeSlots.empty())
+        {
+            index = freeSlots.back();
+            freeSlots.pop_back();
+            slots[index].emplace(std::move(value));
+        }
+        else
+        {
+            index = static_cast<uint32_t>(slots.size());
+            LGT_ASSERT_MSG(index < ASSET_INDEX_MASK, "[AssetRegistry] Asset slots exhausted.");
+            slots.emplace_back(std::move(value));
+            if (index >= generations.size())
+                generations.push_back(0);
+        }
+        return makeAssetHandle(index, generations[index]);
+    }
+
+    // Frees the slot of a valid handle; its next occupant gets a new generation.
+    template <typename T>
+    void releaseSlot(std::vector<std::optional<T>>& slots, std::vector<uint32_t>& freeSlots, std::vector<uint32_t>& generations, uint32_t handle)
+    {
+        const uint32_t index = assetIndex(handle);
+        slots[index].reset();
+        generations[index] = (generations[index] + 1) & ASSET_GENERATION_MASK;
+        freeSlots.push_back(index);
+    }
+}
+
+MeshHandle AssetRegistry::addMesh(Mesh&& mesh)
+{
+    return addToSlot(m_Meshes, m_FreeMeshes, m_MeshGenerations, std::move(mesh));
+}
+
+MaterialHandle AssetRegistry::addMaterial(MaterialAsset&& material)
+{
+    return addToSlot(m_Materials, m_FreeMaterials, m_MaterialGenerations, std::move(material));
+}
+
+void AssetRegistry::releaseMesh(MeshHandle handle)
+{
+    if (!isValid(handle))
+        return;
+    m_Meshes[assetIndex(handle)]->cleanUp();
+    releaseSlot(m_Meshes, m_FreeMeshes, m_MeshGenerations, handle);
+}
+
+void AssetRegistry::releaseMaterial(MaterialHandle handle)
+{
+    if (!isValidMaterial(handle))
+        return;
+    releaseSlot(m_Materials, m_FreeMaterials, m_MaterialGenerations, handle);
+}
+
+void AssetRegistry::clear()
+{
+    for (auto& mesh : m_Meshes)
+    {
+        if (mesh)
+            mesh->cleanUp();
+    }
+    m_Meshes.clear();
+    GeometryBuffer::get().cleanUp(); // every range is gone, drop the shared buffers too
+    m_Materials.clear();
+    m_FreeMeshes.clear();
+    m_FreeMaterials.clear();
+    // slots restart from index 0, handles from before the clear must not match them
+    for (uint32_t& generation : m_MeshGenerations)
+        generation = (generation + 1) & ASSET_GENERATION_MASK;
+    for (uint32_t& generation : m_MaterialGenerations)
+        generation = (generation + 1) & ASSET_GENERATION_MASK;
+}
+
+const Mesh& AssetRegistry::getMesh(MeshHandle handle) const
+{
+    LGT_ASSERT_MSG(isValid(handle), "[AssetRegistry::getMesh] Invalid or released mesh handle.");
+    return *m_Meshes[assetIndex(handle)];
+}
+
+const MaterialAsset& AssetRegistry::getMaterial(MaterialHandle handle) const
+{
+    LGT_ASSERT_MSG(isValidMaterial(handle), "[AssetRegistry::getMaterial] Invalid or released material handle.");
+    return *m_Materials[assetIndex(handle)];
+}
+
+void AssetRegistry::draw(const SubMesh& subMesh, const shader& Shader) const
+{
+    Shader.use();
+    if (subMesh.material != InvalidAsset)
+        getMaterial(subMesh.material).bind(Shader);
+    getMesh(subMesh.mesh).draw();
+}
\ No newline at end of file
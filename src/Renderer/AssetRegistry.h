@@ -0,0 +1,79 @@
+#pragma once
+#include "Mesh.h"
+
+#include <vector>
+#include <memory>
+#include <optional>
+#include <cstdint>
+
+// Small integer handles into the AssetRegistry, cheap to copy and store in components.
+// A handle packs the slot index (low ASSET_INDEX_BITS) and the slot generation (the
+// rest); releasing an asset bumps its slot's generation, so a handle kept past the
+// release is rejected instead of reaching whatever reuses the slot.
+using MeshHandle = uint32_t;
+using MaterialHandle = uint32_t;
+constexpr uint32_t InvalidAsset = UINT32_MAX;
+constexpr uint32_t ASSET_INDEX_BITS = 20;
+constexpr uint32_t ASSET_INDEX_MASK = (1u << ASSET_INDEX_BITS) - 1;
+constexpr uint32_t ASSET_GENERATION_MASK = UINT32_MAX >> ASSET_INDEX_BITS;
+
+constexpr uint32_t assetIndex(uint32_t handle)      { return handle & ASSET_INDEX_MASK; }
+constexpr uint32_t assetGeneration(uint32_t handle) { return handle >> ASSET_INDEX_BITS; }
+constexpr uint32_t makeAssetHandle(uint32_t index, uint32_t generation) {
+    return (generation & ASSET_GENERATION_MASK) << ASSET_INDEX_BITS | index;
+}
+
+// Surface parameters and textures, shared by every mesh drawn with them.
+struct MaterialAsset {
+    Material params;
+    std::vector<std::shared_ptr<Texture>> textures;
+
+    // Binds the textures to consecutive units (color shaders only).
+    void bind(const shader& Shader) const;
+};
+
+// One draw : geometry plus the material it is drawn with.
+struct SubMesh {
+    MeshHandle mesh = InvalidAsset;
+    MaterialHandle material = InvalidAsset;
+};
+
+// Owns every mesh and material once; everything else refers to them by handle.
+// Released slots are reused by the next add under a new generation, so a handle is only
+// valid until it is released (or clear() is called); isValid() tells, get*() asserts it.
+class AssetRegistry {
+public:
+    static AssetRegistry& get();
+
+    MeshHandle addMesh(Mesh&& mesh);
+    MaterialHandle addMaterial(MaterialAsset&& material);
+    // Deletes the GL buffers / drops the textures and frees the slot.
+    void releaseMesh(MeshHandle handle);
+    void releaseMaterial(MaterialHandle handle);
+    void clear();
+
+    bool isValid(MeshHandle handle) const {
+        const uint32_t index = assetIndex(handle);
+        return index < m_Meshes.size() && m_Meshes[index].has_value() && m_MeshGenerations[index] == assetGeneration(handle);
+    }
+    bool isValidMaterial(MaterialHandle handle) const {
+        const uint32_t index = assetIndex(handle);
+        return index < m_Materials.size() && m_Materials[index].has_value() && m_MaterialGenerations[index] == assetGeneration(handle);
+    }
+    const Mesh& getMesh(MeshHandle handle) const;
+    const MaterialAsset& getMaterial(MaterialHandle handle) const;
+
+    // Binds the material (when there is one) and draws the mesh with Shader.
+    void draw(const SubMesh& subMesh, const shader& Shader) const;
+
+    size_t getMeshCount() const { return m_Meshes.size() - m_FreeMeshes.size(); }
+    size_t getMaterialCount() const { return m_Materials.size() - m_FreeMaterials.size(); }
+
+private:
+    std::vector<std::optional<Mesh>> m_Meshes;
+    std::vector<std::optional<MaterialAsset>> m_Materials;
+    std::vector<uint32_t> m_FreeMeshes;    // slot indices
+    std::vector<uint32_t> m_FreeMaterials;
+    std::vector<uint32_t> m_MeshGenerations; // per slot, kept across clear()
+    std::vector<uint32_t> m_MaterialGenerations;
+};
\ No newline at end of file
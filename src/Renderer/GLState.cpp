@@ -0,0 +1,255 @@
+#include "GLState.h"
+#include "Logger.h"
+#include "ecs/Core.h"
+
+#include <string>
+
+static const char* CALL_NAMES[GLState::CallCount] = {
+    "Program", "VertexArray", "Texture", "Framebuffer", "Viewport", "Capability", "BlendFunc", "DepthMask", "CullFace"
+};
+
+const char* GLState::getCallName(Call call)
+{
+    return call < CallCount ? CALL_NAMES[call] : "Unknown";
+}
+
+GLState& GLState::get()
+{
+    static GLState state;
+    return state;
+}
+
+GLState::GLState()
+{
+    invalidate();
+}
+
+void GLState::invalidate()
+{
+    m_Program     = Unknown;
+    m_VertexArray = Unknown;
+    m_Framebuffer = Unknown;
+    m_ActiveUnit  = Unknown;
+    for (GLuint& texture : m_Textures)
+        texture = Unknown;
+    for (int& value : m_Viewport)
+        value = -1;
+    for (int8_t& capability : m_Capabilities)
+        capability = UnknownFlag;
+    m_BlendSource      = Unknown;
+    m_BlendDestination = Unknown;
+    m_DepthMask        = UnknownFlag;
+    m_CullFace         = Unknown;
+}
+
+static int capabilityIndex(GLenum capability)
+{
+    switch (capability) {
+    case GL_BLEND:      return 0;
+    case GL_DEPTH_TEST: return 1;
+    case GL_CULL_FACE:  return 2;
+    default:            return -1;
+    }
+}
+
+bool GLState::matchesGL(Call call, GLenum capability, unsigned int unit) const
+{
+    GLint value[4] = {};
+    switch (call) {
+    case Program:
+        glGetIntegerv(GL_CURRENT_PROGRAM, value);
+        return GLuint(value[0]) == m_Program;
+    case VertexArray:
+        glGetIntegerv(GL_VERTEX_ARRAY_BINDING, value);
+        return GLuint(value[0]) == m_VertexArray;
+    case Texture: {
+        GLint active = 0;
+        glGetIntegerv(GL_ACTIVE_TEXTURE, &active);
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, value);
+        glActiveTexture(active);
+        return GLuint(value[0]) == m_Textures[unit];
+    }
+    case Framebuffer:
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, value);
+        return GLuint(value[0]) == m_Framebuffer;
+    case Viewport:
+        glGetIntegerv(GL_VIEWPORT, value);
+        return value[0] == m_Viewport[0] && value[1] == m_Viewport[1] && value[2] == m_Viewport[2] && value[3] == m_Viewport[3];
+    case Capability:
+        return (glIsEnabled(capability) == GL_TRUE) == (m_Capabilities[capabilityIndex(capability)] == 1);
+    case BlendFunc: {
+        GLint destination = 0;
+        glGetIntegerv(GL_BLEND_SRC_RGB, value);
+        glGetIntegerv(GL_BLEND_DST_RGB, &destination);
+        return GLenum(value[0]) == m_BlendSource && GLenum(destination) == m_BlendDestination;
+    }
+    case DepthMask: {
+        GLboolean write = GL_FALSE;
+        glGetBooleanv(GL_DEPTH_WRITEMASK, &write);
+        return (write == GL_TRUE) == (m_DepthMask == 1);
+    }
+    case CullFace:
+        glGetIntegerv(GL_CULL_FACE_MODE, value);
+        return GLenum(value[0]) == m_CullFace;
+    default:
+        return true;
+    }
+}
+
+bool GLState::filter(Call call, bool unchanged, bool matches)
+{
+    if (!unchanged) {
+        m_Stats.issued[call]++;
+        return false;
+    }
+    if (!matches) {
+        // someone changed the state without telling us, issue the call to resync
+        m_Stats.mismatches++;
+        m_Stats.issued[call]++;
+        LOG(LogLevel::_ERROR, std::string("[GLState] Shadow state out of sync with GL : ") + getCallName(call));
+        return false;
+    }
+    m_Stats.filtered[call]++;
+    return true;
+}
+
+void GLState::useProgram(GLuint program)
+{
+    const bool unchanged = program == m_Program;
+    if (filter(Program, unchanged, !(unchanged && m_Validate) || matchesGL(Program)))
+        return;
+    glUseProgram(program);
+    m_Program = program;
+}
+
+void GLState::bindVertexArray(GLuint vao)
+{
+    const bool unchanged = vao == m_VertexArray;
+    if (filter(VertexArray, unchanged, !(unchanged && m_Validate) || matchesGL(VertexArray)))
+        return;
+    glBindVertexArray(vao);
+    m_VertexArray = vao;
+}
+
+void GLState::activeTexture(unsigned int unit)
+{
+    if (unit == m_ActiveUnit)
+        return;
+    glActiveTexture(GL_TEXTURE0 + unit);
+    m_ActiveUnit = unit;
+}
+
+void GLState::bindTexture(unsigned int unit, GLuint texture)
+{
+    LGT_ASSERT_MSG(unit < MAX_TEXTURE_UNITS, "[GLState::bindTexture] Texture unit out of range.");
+    const bool unchanged = texture == m_Textures[unit];
+    if (filter(Texture, unchanged, !(unchanged && m_Validate) || matchesGL(Texture, 0, unit)))
+        return;
+    activeTexture(unit);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    m_Textures[unit] = texture;
+}
+
+void GLState::bindTexture(GLuint texture)
+{
+    if (m_ActiveUnit == Unknown) {
+        // don't know which unit is active, bind blind and forget every unit
+        m_Stats.issued[Texture]++;
+        glBindTexture(GL_TEXTURE_2D, texture);
+        for (GLuint& bound : m_Textures)
+            bound = Unknown;
+        return;
+    }
+    bindTexture(m_ActiveUnit, texture);
+}
+
+void GLState::bindFramebuffer(GLuint fbo)
+{
+    const bool unchanged = fbo == m_Framebuffer;
+    if (filter(Framebuffer, unchanged, !(unchanged && m_Validate) || matchesGL(Framebuffer)))
+        return;
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    m_Framebuffer = fbo;
+}
+
+void GLState::setViewport(int x, int y, int width, int height)
+{
+    const bool unchanged = x == m_Viewport[0] && y == m_Viewport[1] && width == m_Viewport[2] && height == m_Viewport[3];
+    if (filter(Viewport, unchanged, !(unchanged && m_Validate) || matchesGL(Viewport)))
+        return;
+    glViewport(x, y, width, height);
+    m_Viewport[0] = x;
+    m_Viewport[1] = y;
+    m_Viewport[2] = width;
+    m_Viewport[3] = height;
+}
+
+void GLState::setEnabled(GLenum capability, bool enabled)
+{
+    const int index = capabilityIndex(capability);
+    if (index < 0) {
+        enabled ? glEnable(capability) : glDisable(capability);
+        return;
+    }
+    const bool unchanged = m_Capabilities[index] == int8_t(enabled);
+    if (filter(Capability, unchanged, !(unchanged && m_Validate) || matchesGL(Capability, capability)))
+        return;
+    enabled ? glEnable(capability) : glDisable(capability);
+    m_Capabilities[index] = int8_t(enabled);
+}
+
+void GLState::blendFunc(GLenum source, GLenum destination)
+{
+    const bool unchanged = source == m_BlendSource && destination == m_BlendDestination;
+    if (filter(BlendFunc, unchanged, !(unchanged && m_Validate) || matchesGL(BlendFunc)))
+        return;
+    glBlendFunc(source, destination);
+    m_BlendSource = source;
+    m_BlendDestination = destination;
+}
+
+void GLState::depthMask(bool write)
+{
+    const bool unchanged = m_DepthMask == int8_t(write);
+    if (filter(DepthMask, unchanged, !(unchanged && m_Validate) || matchesGL(DepthMask)))
+        return;
+    glDepthMask(write ? GL_TRUE : GL_FALSE);
+    m_DepthMask = int8_t(write);
+}
+
+void GLState::cullFace(GLenum face)
+{
+    const bool unchanged = face == m_CullFace;
+    if (filter(CullFace, unchanged, !(unchanged && m_Validate) || matchesGL(CullFace)))
+        return;
+    glCullFace(face);
+    m_CullFace = face;
+}
+
+void GLState::onProgramDeleted(GLuint program)
+{
+    // a deleted program stays current until another one is used, but its name can be reused
+    if (program == m_Program)
+        m_Program = Unknown;
+}
+
+void GLState::onVertexArrayDeleted(GLuint vao)
+{
+    if (vao == m_VertexArray)
+        m_VertexArray = 0;
+}
+
+void GLState::onTextureDeleted(GLuint texture)
+{
+    for (GLuint& bound : m_Textures) {
+        if (bound == texture)
+            bound = 0;
+    }
+}
+
+void GLState::onFramebufferDeleted(GLuint fbo)
+{
+    if (fbo == m_Framebuffer)
+        m_Framebuffer = 0;
+}
\ No newline at end of file
@@ -0,0 +1,86 @@
+#pragma once
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <cstdint>
+
+// Shadow copy of the GL state the renderer changes : bound program, VAO, 2D texture per
+// unit, framebuffer, blend / depth / cull state and viewport. A call that would leave the
+// state as it is never reaches GL.
+// Every bind and toggle in the renderer goes through GLState::get(); code that changes the
+// same state behind its back (ImGui's backend, another library) must call invalidate()
+// afterwards. Unknown entries always go to GL.
+class GLState {
+public:
+    enum Call : uint8_t { Program, VertexArray, Texture, Framebuffer, Viewport, Capability, BlendFunc, DepthMask, CullFace, CallCount };
+    static const char* getCallName(Call call);
+
+    struct Stats {
+        size_t issued[CallCount]   = {};
+        size_t filtered[CallCount] = {};
+        size_t mismatches          = 0; // validation only : shadow differed from glGet*
+    };
+
+    static constexpr unsigned int MAX_TEXTURE_UNITS = 32;
+
+    static GLState& get();
+
+    void useProgram(GLuint program);
+    void bindVertexArray(GLuint vao);
+    // GL_TEXTURE_2D on that unit; switches the active unit only when the bind goes through.
+    void bindTexture(unsigned int unit, GLuint texture);
+    // GL_TEXTURE_2D on whatever unit is active (texture creation / upload).
+    void bindTexture(GLuint texture);
+    void bindFramebuffer(GLuint fbo);
+    void setViewport(int x, int y, int width, int height);
+    // GL_BLEND, GL_DEPTH_TEST and GL_CULL_FACE are shadowed, other capabilities pass through.
+    void setEnabled(GLenum capability, bool enabled);
+    void blendFunc(GLenum source, GLenum destination);
+    void depthMask(bool write);
+    void cullFace(GLenum face);
+
+    // GL unbinds deleted objects (programs stay current), the shadow forgets them too.
+    void onProgramDeleted(GLuint program);
+    void onVertexArrayDeleted(GLuint vao);
+    void onTextureDeleted(GLuint texture);
+    void onFramebufferDeleted(GLuint fbo);
+
+    // Forgets everything : the next call of every kind goes to GL.
+    void invalidate();
+
+    // Debug mode : before filtering a call, read the real state back with glGet* and log
+    // (and count) any difference. Stalls the pipeline; for tracking down missing invalidate().
+    void setValidation(bool enabled) { m_Validate = enabled; }
+    bool isValidating() const { return m_Validate; }
+
+    const Stats& getStats() const { return m_Stats; }
+    void resetStats() { m_Stats = Stats(); }
+
+private:
+    static constexpr GLuint  Unknown     = ~GLuint(0);
+    static constexpr int8_t  UnknownFlag = -1;
+
+    static constexpr int CapabilityCount = 3; // GL_BLEND, GL_DEPTH_TEST, GL_CULL_FACE
+
+    GLuint m_Program     = Unknown;
+    GLuint m_VertexArray = Unknown;
+    GLuint m_Framebuffer = Unknown;
+    GLuint m_ActiveUnit  = Unknown;
+    GLuint m_Textures[MAX_TEXTURE_UNITS];
+    int    m_Viewport[4] = { -1, -1, -1, -1 };
+    int8_t m_Capabilities[CapabilityCount] = { UnknownFlag, UnknownFlag, UnknownFlag };
+    GLenum m_BlendSource      = Unknown;
+    GLenum m_BlendDestination = Unknown;
+    int8_t m_DepthMask        = UnknownFlag;
+    GLenum m_CullFace         = Unknown;
+
+    bool  m_Validate = false;
+    Stats m_Stats;
+
+    GLState();
+    void activeTexture(unsigned int unit);
+    // Counts the call; in validation mode first compares the shadow with the real value.
+    // Returns true when the call can be skipped.
+    bool filter(Call call, bool unchanged, bool matchesGL);
+    bool matchesGL(Call call, GLenum capability = 0, unsigned int unit = 0) const;
+};
\ No newline at end of file
@@ -0,0 +1,177 @@
+#include "GeometryBuffer.h"
+
+#include <algorithm>
+#include <numeric>
+
+static constexpr size_t INITIAL_VERTICES = 64 * 1024;
+static constexpr size_t INITIAL_INDICES  = 256 * 1024;
+
+size_t GeometryBuffer::Ranges::allocate(size_t count)
+{
+    for (size_t i = 0; i < free.size(); i++) {
+        Range& range = free[i];
+        if (range.count < count)
+            continue;
+        const size_t offset = range.offset;
+        range.offset += count;
+        range.count -= count;
+        if (range.count == 0)
+            free.erase(free.begin() + i);
+        return offset;
+    }
+    const size_t offset = end;
+    end += count;
+    return offset;
+}
+
+void GeometryBuffer::Ranges::release(size_t offset, size_t count)
+{
+    if (count == 0)
+        return;
+    auto next = std::lower_bound(free.begin(), free.end(), offset, [](const Range& range, size_t value) { return range.offset < value; });
+    next = free.insert(next, { offset, count });
+
+    // merge with the following range, then the preceding one
+    if (next + 1 != free.end() && next->offset + next->count == (next + 1)->offset) {
+        next->count += (next + 1)->count;
+        free.erase(next + 1);
+    }
+    if (next != free.begin() && (next - 1)->offset + (next - 1)->count == next->offset) {
+        (next - 1)->count += next->count;
+        next = free.erase(next) - 1;
+    }
+    // a free range at the tail just moves end back
+    if (next->offset + next->count == end) {
+        end = next->offset;
+        free.erase(next);
+    }
+}
+
+GeometryBuffer& GeometryBuffer::get()
+{
+    static GeometryBuffer instance;
+    return instance;
+}
+
+void GeometryBuffer::create()
+{
+    m_Vertices.capacity = INITIAL_VERTICES;
+    m_Indices.capacity = INITIAL_INDICES;
+    glCreateBuffers(1, &m_VertexBuffer);
+    glNamedBufferData(m_VertexBuffer, m_Vertices.capacity * sizeof(vertex), nullptr, GL_STATIC_DRAW);
+    glCreateBuffers(1, &m_IndexBuffer);
+    glNamedBufferData(m_IndexBuffer, m_Indices.capacity * sizeof(unsigned int), nullptr, GL_STATIC_DRAW);
+
+    glCreateVertexArrays(1, &m_VAO);
+    glVertexArrayVertexBuffer(m_VAO, 0, m_VertexBuffer, 0, sizeof(vertex));
+    glVertexArrayElementBuffer(m_VAO, m_IndexBuffer);
+
+    // same locations as the per-mesh VAOs had : pos, uv, normal, tangent, bitangent
+    const struct { GLuint location; GLint size; GLuint offset; } attributes[] = {
+        { 0, 3, offsetof(vertex, pos) },
+        { 1, 2, offsetof(vertex, textcoord) },
+        { 2, 3, offsetof(vertex, norm) },
+        { 3, 3, offsetof(vertex, tangent) },
+        { 4, 3, offsetof(vertex, bitangent) },
+    };
+    for (const auto& attribute : attributes) {
+        glEnableVertexArrayAttrib(m_VAO, attribute.location);
+        glVertexArrayAttribFormat(m_VAO, attribute.location, attribute.size, GL_FLOAT, GL_FALSE, attribute.offset);
+        glVertexArrayAttribBinding(m_VAO, attribute.location, 0);
+    }
+
+    glEnableVertexArrayAttrib(m_VAO, INSTANCE_ATTRIBUTE);
+    glVertexArrayAttribIFormat(m_VAO, INSTANCE_ATTRIBUTE, 1, GL_UNSIGNED_INT, 0);
+    glVertexArrayAttribBinding(m_VAO, INSTANCE_ATTRIBUTE, 1);
+    glVertexArrayBindingDivisor(m_VAO, 1, 1);
+    reserveInstances(1024);
+}
+
+void GeometryBuffer::grow(GLuint& buffer, size_t usedBytes, size_t newCapacity)
+{
+    GLuint grown = 0;
+    glCreateBuffers(1, &grown);
+    glNamedBufferData(grown, newCapacity, nullptr, GL_STATIC_DRAW);
+    if (usedBytes > 0)
+        glCopyNamedBufferSubData(buffer, grown, 0, 0, usedBytes);
+    glDeleteBuffers(1, &buffer);
+    buffer = grown;
+}
+
+GeometryRange GeometryBuffer::allocate(const std::vector<vertex>& vertices, const std::vector<unsigned int>& indices)
+{
+    if (m_VAO == 0)
+        create();
+
+    const size_t usedVertices = m_Vertices.end;
+    const size_t usedIndices = m_Indices.end;
+    GeometryRange range;
+    range.baseVertex = static_cast<GLint>(m_Vertices.allocate(vertices.size()));
+    range.vertexCount = static_cast<GLuint>(vertices.size());
+    range.firstIndex = static_cast<GLuint>(m_Indices.allocate(indices.size()));
+    range.indexCount = static_cast<GLsizei>(indices.size());
+
+    if (m_Vertices.end > m_Vertices.capacity) {
+        const size_t capacity = std::max(m_Vertices.end, m_Vertices.capacity * 2);
+        grow(m_VertexBuffer, usedVertices * sizeof(vertex), capacity * sizeof(vertex));
+        m_Vertices.capacity = capacity;
+        glVertexArrayVertexBuffer(m_VAO, 0, m_VertexBuffer, 0, sizeof(vertex));
+    }
+    if (m_Indices.end > m_Indices.capacity) {
+        const size_t capacity = std::max(m_Indices.end, m_Indices.capacity * 2);
+        grow(m_IndexBuffer, usedIndices * sizeof(unsigned int), capacity * sizeof(unsigned int));
+        m_Indices.capacity = capacity;
+        glVertexArrayElementBuffer(m_VAO, m_IndexBuffer);
+    }
+
+    glNamedBufferSubData(m_VertexBuffer, range.baseVertex * sizeof(vertex), vertices.size() * sizeof(vertex), vertices.data());
+    glNamedBufferSubData(m_IndexBuffer, range.firstIndex * sizeof(unsigned int), indices.size() * sizeof(unsigned int), indices.data());
+    return range;
+}
+
+void GeometryBuffer::release(const GeometryRange& range)
+{
+    m_Vertices.release(range.baseVertex, range.vertexCount);
+    m_Indices.release(range.firstIndex, range.indexCount);
+}
+
+void GeometryBuffer::reserveInstances(size_t count)
+{
+    if (m_VAO == 0)
+        create();
+    if (count <= m_InstanceCapacity)
+        return;
+
+    m_InstanceCapacity = std::max(count, m_InstanceCapacity * 2);
+    std::vector<GLuint> identity(m_InstanceCapacity);
+    std::iota(identity.begin(), identity.end(), 0u);
+    if (m_InstanceBuffer != 0)
+        glDeleteBuffers(1, &m_InstanceBuffer);
+    glCreateBuffers(1, &m_InstanceBuffer);
+    glNamedBufferData(m_InstanceBuffer, identity.size() * sizeof(GLuint), identity.data(), GL_STATIC_DRAW);
+    glVertexArrayVertexBuffer(m_VAO, 1, m_InstanceBuffer, 0, sizeof(GLuint));
+}
+
+GLuint GeometryBuffer::getVertexArray()
+{
+    if (m_VAO == 0)
+        create();
+    return m_VAO;
+}
+
+void GeometryBuffer::bind()
+{
+    GLState::get().bindVertexArray(getVertexArray());
+}
+
+void GeometryBuffer::cleanUp()
+{
+    if (m_VAO == 0)
+        return;
+    GLState::get().onVertexArrayDeleted(m_VAO);
+    glDeleteVertexArrays(1, &m_VAO);
+    glDeleteBuffers(1, &m_VertexBuffer);
+    glDeleteBuffers(1, &m_IndexBuffer);
+    glDeleteBuffers(1, &m_InstanceBuffer);
+    *this = GeometryBuffer();
+}
\ No newline at end of file
@@ -0,0 +1,88 @@
+#pragma once
+#include "renderer.h"
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+struct vertex {
+    glm::vec3 pos;
+    glm::vec3 norm;
+    glm::vec2 textcoord;
+    glm::vec3 tangent;
+    glm::vec3 bitangent;
+};
+
+// Layout glMultiDrawElementsIndirect reads from GL_DRAW_INDIRECT_BUFFER.
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint  baseVertex;
+    GLuint baseInstance;
+};
+
+// Where a mesh lives inside the GeometryBuffer, in vertices / indices.
+struct GeometryRange {
+    GLint   baseVertex = 0;
+    GLuint  vertexCount = 0;
+    GLuint  firstIndex = 0;
+    GLsizei indexCount = 0;
+};
+
+// Every static mesh suballocated from one vertex buffer and one index buffer behind a
+// single VAO, so draws never switch vertex state and a whole pass can be one
+// glMultiDrawElementsIndirect. Buffers grow by doubling (the old contents are copied on
+// the GPU); released ranges are reused first fit.
+//
+// Besides the vertex attributes 0-4, the VAO feeds attribute 5 with the instance index
+// (divisor 1, read from an identity buffer), so a shader finds its per-instance data with
+// baseInstance + gl_InstanceID on plain GL 4.5, without gl_BaseInstance.
+class GeometryBuffer {
+public:
+    static constexpr GLuint INSTANCE_ATTRIBUTE = 5;
+
+    static GeometryBuffer& get();
+
+    GeometryRange allocate(const std::vector<vertex>& vertices, const std::vector<unsigned int>& indices);
+    void release(const GeometryRange& range);
+    // Makes attribute 5 cover instance indices [0, count).
+    void reserveInstances(size_t count);
+
+    // Creates the GL objects on first use.
+    GLuint getVertexArray();
+    void bind();
+
+    // Deletes the GL objects; every range handed out before is invalid afterwards.
+    void cleanUp();
+
+    size_t getVertexBytes() const { return m_Vertices.end * sizeof(vertex); }
+    size_t getIndexBytes() const { return m_Indices.end * sizeof(unsigned int); }
+    size_t getReservedBytes() const { return m_Vertices.capacity * sizeof(vertex) + m_Indices.capacity * sizeof(unsigned int); }
+
+private:
+    // First fit over [0, capacity) in elements; free ranges kept sorted and merged.
+    struct Ranges {
+        struct Range { size_t offset, count; };
+        std::vector<Range> free;
+        size_t end = 0;      // everything past end is free
+        size_t capacity = 0;
+
+        // Offset of count elements; may move end past capacity, the caller grows the buffer.
+        size_t allocate(size_t count);
+        void   release(size_t offset, size_t count);
+    };
+
+    GLuint m_VAO = 0;
+    GLuint m_VertexBuffer = 0;
+    GLuint m_IndexBuffer = 0;
+    GLuint m_InstanceBuffer = 0;
+    size_t m_InstanceCapacity = 0;
+    Ranges m_Vertices;
+    Ranges m_Indices;
+
+    GeometryBuffer() = default;
+    void create();
+    // Replaces buffer by one of newCapacity bytes holding the first usedBytes of it.
+    static void grow(GLuint& buffer, size_t usedBytes, size_t newCapacity);
+};
\ No newline at end of file
@@ -0,0 +1,149 @@
+#include "GpuCulling.h"
+#include "RenderQueue.h"
+
+#include <algorithm>
+#include <cmath>
+
+static constexpr GLuint CULL_GROUP_SIZE = 64;
+static constexpr GLuint HIZ_GROUP_SIZE = 8;
+static constexpr size_t INSTANCE_BYTES = 2 * sizeof(glm::mat4); // RenderQueue::InstanceData
+
+// Gribb / Hartmann : the six planes of a view-projection matrix, normals pointing inside.
+static void extractPlanes(const glm::mat4& m, glm::vec4 planes[6])
+{
+    const glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+    const glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+    const glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+    const glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+    planes[0] = row3 + row0; // left
+    planes[1] = row3 - row0; // right
+    planes[2] = row3 + row1; // bottom
+    planes[3] = row3 - row1; // top
+    planes[4] = row3 + row2; // near
+    planes[5] = row3 - row2; // far
+    for (int i = 0; i < 6; i++)
+        planes[i] /= glm::length(glm::vec3(planes[i]));
+}
+
+GpuCulling::GpuCulling()
+    : m_CullShader("res/shaders/Cull.shader")
+    , m_HiZShader("res/shaders/HiZ.shader")
+{
+    glCreateBuffers(1, &m_Counter);
+    glNamedBufferData(m_Counter, sizeof(GLuint), nullptr, GL_DYNAMIC_READ);
+}
+
+GpuCulling::~GpuCulling()
+{
+    glDeleteBuffers(1, &m_Visible);
+    glDeleteBuffers(1, &m_InstanceCommands);
+    glDeleteBuffers(1, &m_Bounds);
+    glDeleteBuffers(1, &m_Counter);
+    if (m_HiZ != 0) {
+        GLState::get().onTextureDeleted(m_HiZ);
+        glDeleteTextures(1, &m_HiZ);
+    }
+}
+
+void GpuCulling::upload(GLuint& buffer, size_t& capacity, const void* data, size_t bytes)
+{
+    if (bytes > capacity || buffer == 0) {
+        capacity = std::max(bytes, capacity * 2);
+        if (buffer != 0)
+            glDeleteBuffers(1, &buffer);
+        glCreateBuffers(1, &buffer);
+        glNamedBufferData(buffer, capacity, nullptr, GL_STREAM_DRAW);
+    }
+    else {
+        glInvalidateBufferData(buffer); // orphan, a previous cull may still read it
+    }
+    if (bytes > 0)
+        glNamedBufferSubData(buffer, 0, bytes, data);
+}
+
+void GpuCulling::cull(GLuint instances, const std::vector<GLuint>& instanceCommands, GLuint commands,
+                      const std::vector<glm::vec4>& commandBounds, const glm::mat4& viewProjection, bool occlusion)
+{
+    if (!isValid() || instanceCommands.empty())
+        return;
+
+    const size_t count = instanceCommands.size();
+    upload(m_InstanceCommands, m_InstanceCommandsCapacity, instanceCommands.data(), count * sizeof(GLuint));
+    upload(m_Bounds, m_BoundsCapacity, commandBounds.data(), commandBounds.size() * sizeof(glm::vec4));
+    if (count * INSTANCE_BYTES > m_VisibleCapacity || m_Visible == 0) {
+        m_VisibleCapacity = std::max(count * INSTANCE_BYTES, m_VisibleCapacity * 2);
+        glDeleteBuffers(1, &m_Visible);
+        glCreateBuffers(1, &m_Visible);
+        glNamedBufferData(m_Visible, m_VisibleCapacity, nullptr, GL_DYNAMIC_COPY);
+    }
+    const GLuint zero = 0;
+    glClearNamedBufferData(m_Counter, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, RenderQueue::INSTANCE_BINDING, m_Visible);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, m_InstanceCommands);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, m_Bounds);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, commands);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, instances);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, m_Counter);
+
+    glm::vec4 planes[6];
+    extractPlanes(viewProjection, planes);
+    m_CullShader.use();
+    m_CullShader.setInt("u_instanceCount", static_cast<int>(count));
+    m_CullShader.setMat4("u_viewProjection", viewProjection);
+    for (int i = 0; i < 6; i++)
+        m_CullShader.setVec4("u_planes[" + std::to_string(i) + "]", planes[i]);
+    m_CullShader.setBool("u_occlusion", occlusion && hasHiZ());
+    if (hasHiZ())
+        GLState::get().bindTexture(HIZ_TEXTURE_UNIT, m_HiZ);
+
+    m_CullShader.dispatch(static_cast<GLuint>((count + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE));
+    // the draws read the commands and the culled instances next
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+void GpuCulling::buildHiZ(GLuint depthTexture, int width, int height)
+{
+    if (!isValid() || width <= 0 || height <= 0)
+        return;
+
+    if (m_HiZ == 0 || width != m_HiZWidth || height != m_HiZHeight) {
+        if (m_HiZ != 0) {
+            GLState::get().onTextureDeleted(m_HiZ);
+            glDeleteTextures(1, &m_HiZ);
+        }
+        m_HiZWidth = width;
+        m_HiZHeight = height;
+        m_HiZLevels = 1 + static_cast<int>(std::floor(std::log2(static_cast<float>(std::max(width, height)))));
+        glCreateTextures(GL_TEXTURE_2D, 1, &m_HiZ);
+        glTextureStorage2D(m_HiZ, m_HiZLevels, GL_R32F, width, height);
+        glTextureParameteri(m_HiZ, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+        glTextureParameteri(m_HiZ, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTextureParameteri(m_HiZ, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTextureParameteri(m_HiZ, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+
+    GLState::get().bindTexture(HIZ_TEXTURE_UNIT, depthTexture);
+    m_HiZShader.use();
+    int levelWidth = width, levelHeight = height;
+    for (int level = 0; level < m_HiZLevels; level++) {
+        m_HiZShader.setBool("u_copyDepth", level == 0);
+        if (level > 0)
+            glBindImageTexture(0, m_HiZ, level - 1, GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+        glBindImageTexture(1, m_HiZ, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+        m_HiZShader.dispatch((levelWidth + HIZ_GROUP_SIZE - 1) / HIZ_GROUP_SIZE, (levelHeight + HIZ_GROUP_SIZE - 1) / HIZ_GROUP_SIZE);
+        // the next level reads this one
+        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+        levelWidth = std::max(1, levelWidth / 2);
+        levelHeight = std::max(1, levelHeight / 2);
+    }
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+}
+
+GLuint GpuCulling::readVisibleCount() const
+{
+    GLuint count = 0;
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    glGetNamedBufferSubData(m_Counter, 0, sizeof(GLuint), &count);
+    return count;
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+#include "renderer.h"
+
+#include <vector>
+
+// Frustum and occlusion culling on the GPU for RenderQueue's multi-draw path.
+//
+// cull() runs one compute invocation per instance : its mesh's bounding sphere is tested
+// against the frustum planes and, when a pyramid exists, against the Hi-Z pyramid built
+// from the previous frame's depth. Survivors are appended (atomically) to the range of
+// their draw command, whose instanceCount the GPU fills in, so the CPU never sees
+// per-object visibility. The culled instance buffer replaces the uploaded one at binding 0.
+//
+// Plain GL 4.5 core : no gl_BaseInstance / draw-count extensions, so it also runs on
+// software rasterizers such as llvmpipe. Without a draw-count, commands whose instances
+// were all culled stay in the buffer with instanceCount 0.
+class GpuCulling {
+public:
+    static constexpr GLuint HIZ_TEXTURE_UNIT = 15;
+
+    GpuCulling();
+    ~GpuCulling();
+    GpuCulling(const GpuCulling&) = delete;
+    GpuCulling& operator=(const GpuCulling&) = delete;
+
+    bool isValid() const { return m_CullShader.isValid() && m_HiZShader.isValid(); }
+
+    // instances : SSBO of RenderQueue instance data (model + normal matrix per instance)
+    // instanceCommands : draw command of each instance
+    // commands : GL_DRAW_INDIRECT_BUFFER contents, instanceCount zeroed, baseInstance the
+    //            start of the command's range in the output
+    // commandBounds : local bounding sphere of each command's mesh
+    void cull(GLuint instances, const std::vector<GLuint>& instanceCommands, GLuint commands,
+              const std::vector<glm::vec4>& commandBounds, const glm::mat4& viewProjection, bool occlusion);
+
+    // Rebuilds the pyramid from the depth of the frame just rendered, whose viewport
+    // was (0, 0, width, height). Used by the next occlusion cull.
+    void buildHiZ(GLuint depthTexture, int width, int height);
+    bool hasHiZ() const { return m_HiZ != 0; }
+
+    // Instances that passed the last cull. Reads back from the GPU and stalls, so for
+    // debugging and tests only.
+    GLuint readVisibleCount() const;
+
+private:
+    shader m_CullShader;
+    shader m_HiZShader;
+    GLuint m_Visible = 0;      // culled instances, same layout as the input
+    size_t m_VisibleCapacity = 0;
+    GLuint m_InstanceCommands = 0;
+    size_t m_InstanceCommandsCapacity = 0;
+    GLuint m_Bounds = 0;
+    size_t m_BoundsCapacity = 0;
+    GLuint m_Counter = 0;
+    GLuint m_HiZ = 0;
+    int    m_HiZWidth = 0, m_HiZHeight = 0, m_HiZLevels = 0;
+
+    // Uploads data into buffer, reallocating it when it outgrows capacity (bytes).
+    static void upload(GLuint& buffer, size_t& capacity, const void* data, size_t bytes);
+};
\ No newline at end of file
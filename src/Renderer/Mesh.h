@@ -1,26 +1,27 @@
 #pragma once
 #include"renderer.h"
+#include"GeometryBuffer.h"
 
-struct vertex {
-    glm::vec3 pos;
-    glm::vec3 norm;
-    glm::vec2 textcoord;
-    glm::vec3 tangent;
-    glm::vec3 bitangent;
-};
+// GPU geometry only : a range of the shared GeometryBuffer. Materials and textures
+// live in the AssetRegistry, which owns every Mesh and hands out handles to it.
 class Mesh {
 private:
 
-    glm::mat4 _transform;
-    Material _material;
-    std::vector<std::shared_ptr<Texture>> Textures;
-    std::vector<unsigned int>m_indices;
-    GLuint m_vao, m_vbo, m_ibo;
+    GeometryRange m_range;
+    glm::vec4 m_bounds; // local bounding sphere : center xyz, radius w
 
 public:
-    Mesh(const std::vector<vertex>& data, const std::vector<unsigned int>& indices,const Material& material , std::vector<std::shared_ptr<Texture>> textures);
+    Mesh(const std::vector<vertex>& data, const std::vector<unsigned int>& indices);
     void cleanUp();
-    void render( const shader& Shader) ;
-    void setTransform(glm::mat4 transform);
-    glm::mat4 getTransform();
+    void draw() const;
+    // draw() split for callers that keep the VAO bound across draws (RenderQueue).
+    // Every mesh shares the GeometryBuffer VAO, so bind() only costs something once.
+    void bind() const;
+    void submit() const;
+    // One indirect command drawing this mesh instanceCount times; per-instance data is
+    // found at baseInstance + gl_InstanceID.
+    DrawElementsIndirectCommand getDrawCommand(GLuint instanceCount, GLuint baseInstance) const;
+    GLsizei getIndexCount() const;
+    const GeometryRange& getRange() const { return m_range; }
+    const glm::vec4& getBounds() const { return m_bounds; }
 };
\ No newline at end of file
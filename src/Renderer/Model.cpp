@@ -29,6 +29,8 @@ Model::Model(const std::string &filepath) : m_ModelFilepath(filepath)
         LOG(LogLevel::DEBUG, "Number of m_Meshes: " + std::to_string(scene->mNumMeshes));
         LOG(LogLevel::DEBUG, "Loading model...");
         LOG(LogLevel::DEBUG, "Processing root node...");
+        m_MeshHandles.assign(scene->mNumMeshes, InvalidAsset);
+        m_MaterialHandles.assign(scene->mNumMaterials, InvalidAsset);
         processNode(scene->mRootNode, scene);
         std::cout << m_Nodes.size();
         LOG(LogLevel::DEBUG, "Model loaded successfully: " + filepath);
@@ -40,13 +42,13 @@ Model::Model(const std::string &filepath, lgt::Scene*_scene) : m_ModelFilepath(f
  
     m_TextureFilePath = std::filesystem::path(filepath).parent_path().string();
     Assimp::Importer importer;
+    // node transforms are kept (no PreTransformVertices) : the scene's hierarchy applies them
     const aiScene *scene = importer.ReadFile(
         filepath,
         aiProcess_Triangulate |
             aiProcess_GenSmoothNormals |
             aiProcess_CalcTangentSpace |
-            aiProcess_GlobalScale |
-            aiProcess_PreTransformVertices);
+            aiProcess_GlobalScale);
     // Error handling
     if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
     {
@@ -61,21 +63,42 @@ Model::Model(const std::string &filepath, lgt::Scene*_scene) : m_ModelFilepath(f
         LOG(LogLevel::DEBUG, "Number of m_Meshes: " + std::to_string(scene->mNumMeshes));
         LOG(LogLevel::DEBUG, "Loading model...");
         LOG(LogLevel::DEBUG, "Processing root node...");
+        m_MeshHandles.assign(scene->mNumMeshes, InvalidAsset);
+        m_MaterialHandles.assign(scene->mNumMaterials, InvalidAsset);
         processNode(scene->mRootNode, scene);
         std::cout << m_Nodes.size();
         LOG(LogLevel::DEBUG, "Model loaded successfully: " + filepath);
-        // create a Scene 
-        for (auto node : m_Nodes)
+        // create a Scene : every node lands in the Renderable archetype in one bulk spawn.
+        // A Renderable draws one SubMesh, so a node's extra meshes get child entities.
+        size_t subEntities = 0;
+        for (const Node &node : m_Nodes)
+            subEntities += node.meshes.size() > 1 ? node.meshes.size() - 1 : 0;
+        std::vector<lgt::EntityHandle> handles = _scene->m_Roster->createEntities(m_Nodes.size() + subEntities, Renderable{});
+        size_t nextSub = m_Nodes.size();
+        for (size_t i = 0; i < m_Nodes.size(); i++)
         {
-            Renderable  component;
-            lgt::Entity  e = _scene->m_Roster->createEntity(node.name);
-             component.Transform = node._transform;
-            for (auto mesh : node.meshes)
+            lgt::Entity  e(handles[i], _scene->m_Roster.get(), m_Nodes[i].name);
+            Renderable& component = e.getComponent<Renderable>();
+            component.Transform = m_Nodes[i]._transform;
+            if (!m_Nodes[i].meshes.empty())
             {
-                    component._meshes.push_back(mesh);
+                component.mesh = m_Nodes[i].meshes[0].mesh;
+                component.material = m_Nodes[i].meshes[0].material;
             }
-            e.addComponent<Renderable>(component);
             _scene->m_Entites.push_back(e);
+
+            // nodes are stored parents first, so the parent handle already exists
+            const lgt::EntityHandle parent = m_Nodes[i].parent >= 0 ? handles[m_Nodes[i].parent] : lgt::NullEntity;
+            _scene->m_Hierarchy.add(handles[i], parent, toMat4(m_Nodes[i]._transform));
+
+            for (size_t k = 1; k < m_Nodes[i].meshes.size(); k++, nextSub++)
+            {
+                Renderable& sub = _scene->m_Roster->getComponent<Renderable>(handles[nextSub]);
+                sub.Transform = m_Nodes[i]._transform;
+                sub.mesh = m_Nodes[i].meshes[k].mesh;
+                sub.material = m_Nodes[i].meshes[k].material;
+                _scene->m_Hierarchy.add(handles[nextSub], handles[i]);
+            }
         }
     }
 }
@@ -85,10 +108,13 @@ void Model::cleanUp()
 {
     LOG(LogLevel::DEBUG, "Destroying model");
 
-    for (size_t i = 0; i < m_Meshes.size(); ++i)
-    {
-        m_Meshes[i].cleanUp();
-    }
+    AssetRegistry &assets = AssetRegistry::get();
+    for (MeshHandle handle : m_MeshHandles)
+        assets.releaseMesh(handle);
+    for (MaterialHandle handle : m_MaterialHandles)
+        assets.releaseMaterial(handle);
+    m_MeshHandles.clear();
+    m_MaterialHandles.clear();
 
     LOG(LogLevel::DEBUG, "Model destroyed");
 }
@@ -127,29 +153,13 @@ Material Model::LoadMaterial(aiMaterial *M) const
     return material;
 }
 
-// Process mesh data
-Mesh Model::processMesh(const aiMesh *mesh, const aiScene *scene)
+// Process mesh data (geometry only, the material is loaded by processMaterial)
+Mesh Model::processMesh(const aiMesh *mesh)
 {
-    // Updated texture type mapping for better organization
-    struct TextureTypeInfo
-    {
-        aiTextureType assimpType;
-        TextureType meshType;
-        std::string name;
-    };
-
-    std::vector<TextureTypeInfo> textureTypes = {
-        {aiTextureType_DIFFUSE, TextureType::DIFFUSE, "diffuse"},
-        {aiTextureType_NORMALS, TextureType::NORMAL, "normal"},
-        {aiTextureType_SPECULAR, TextureType::SPECULAR, "specular"},
-        {aiTextureType_HEIGHT, TextureType::NORMAL, "height"} // Height maps can be used as normal maps
-    };
-
-    Material material;
     std::vector<vertex> Vertices;
     std::vector<unsigned int> Indices;
-    std::vector<std::shared_ptr<Texture>> Textures;
-    glm::mat4 meshTransform;
+    Vertices.reserve(mesh->mNumVertices);
+    Indices.reserve(mesh->mNumFaces * 3);
 
     LOG(LogLevel::_INFO, mesh->HasTangentsAndBitangents() ? "Mesh has tangent and bitangent data" : "Mesh lacks tangent and bitangent data");
 
@@ -204,52 +214,87 @@ Mesh Model::processMesh(const aiMesh *mesh, const aiScene *scene)
     LOG(LogLevel::_INFO, "Number of vertices: " + std::to_string(Vertices.size()));
     LOG(LogLevel::_INFO, "Number of indices: " + std::to_string(Indices.size()));
 
-    // Process material
-    if (mesh->mMaterialIndex >= 0)
+    return Mesh(Vertices, Indices);
+}
+
+// Process a material and its textures into the asset registry
+MaterialHandle Model::processMaterial(unsigned int index, const aiScene *scene)
+{
+    // Updated texture type mapping for better organization
+    struct TextureTypeInfo
+    {
+        aiTextureType assimpType;
+        TextureType meshType;
+        std::string name;
+    };
+
+    std::vector<TextureTypeInfo> textureTypes = {
+        {aiTextureType_DIFFUSE, TextureType::DIFFUSE, "diffuse"},
+        {aiTextureType_NORMALS, TextureType::NORMAL, "normal"},
+        {aiTextureType_SPECULAR, TextureType::SPECULAR, "specular"},
+        {aiTextureType_HEIGHT, TextureType::NORMAL, "height"} // Height maps can be used as normal maps
+    };
+
+    MaterialAsset asset;
+    aiMaterial *M = scene->mMaterials[index];
+    aiString materialName;
+
+    if (M->Get(AI_MATKEY_NAME, materialName) == AI_SUCCESS)
     {
-        aiMaterial *M = scene->mMaterials[mesh->mMaterialIndex];
-        aiString materialName;
+        LOG(LogLevel::_INFO, "Material Name: " + std::string(materialName.C_Str()));
+    }
 
-        if (M->Get(AI_MATKEY_NAME, materialName) == AI_SUCCESS)
-        {
-            LOG(LogLevel::_INFO, "Material Name: " + std::string(materialName.C_Str()));
-        }
+    // Load material properties first
+    asset.params = LoadMaterial(M);
 
-        // Load material properties first
-        material = LoadMaterial(M);
+    // Process textures with improved organization
+    for (auto &typeInfo : textureTypes)
+    {
+        unsigned int textureCount = M->GetTextureCount(typeInfo.assimpType);
 
-        // Process textures with improved organization
-        for (auto &typeInfo : textureTypes)
+        if (textureCount > 0)
         {
-            unsigned int textureCount = M->GetTextureCount(typeInfo.assimpType);
-
-            if (textureCount > 0)
-            {
-                // Update material flags based on available textures
-                if (typeInfo.meshType == TextureType::NORMAL)
-                    material.hasNormalMap = true;
-                else if (typeInfo.meshType == TextureType::SPECULAR)
-                    material.hasSpecularMap = true;
-            }
+            // Update material flags based on available textures
+            if (typeInfo.meshType == TextureType::NORMAL)
+                asset.params.hasNormalMap = true;
+            else if (typeInfo.meshType == TextureType::SPECULAR)
+                asset.params.hasSpecularMap = true;
+        }
 
-            for (unsigned int i = 0; i < textureCount; ++i)
-            {
-                aiString str;
-                M->GetTexture(typeInfo.assimpType, i, &str);
-                std::string texturePath = m_TextureFilePath + "/" + std::string(str.C_Str());
+        for (unsigned int i = 0; i < textureCount; ++i)
+        {
+            aiString str;
+            M->GetTexture(typeInfo.assimpType, i, &str);
+            std::string texturePath = m_TextureFilePath + "/" + std::string(str.C_Str());
 
-                auto texture = std::make_shared<Texture>(texturePath);
-                texture->setType(typeInfo.meshType); // Set the texture type
-                Textures.push_back(texture);
+            auto texture = std::make_shared<Texture>(texturePath);
+            texture->setType(typeInfo.meshType); // Set the texture type
+            asset.textures.push_back(texture);
 
-                LOG(LogLevel::_INFO, "Loaded " + typeInfo.name + " texture " + std::to_string(i + 1) +
-                                         ": " + texturePath);
-            }
+            LOG(LogLevel::_INFO, "Loaded " + typeInfo.name + " texture " + std::to_string(i + 1) +
+                                     ": " + texturePath);
         }
     }
 
-    if (scene)
-        return Mesh(Vertices, Indices, material, Textures);
+    return AssetRegistry::get().addMaterial(std::move(asset));
+}
+
+// Registers an assimp mesh and its material on first use, later uses share the handles
+SubMesh Model::loadSubMesh(unsigned int index, const aiScene *scene)
+{
+    const aiMesh *mesh = scene->mMeshes[index];
+    if (m_MeshHandles[index] == InvalidAsset)
+        m_MeshHandles[index] = AssetRegistry::get().addMesh(processMesh(mesh));
+
+    SubMesh subMesh;
+    subMesh.mesh = m_MeshHandles[index];
+    if (mesh->mMaterialIndex < scene->mNumMaterials)
+    {
+        if (m_MaterialHandles[mesh->mMaterialIndex] == InvalidAsset)
+            m_MaterialHandles[mesh->mMaterialIndex] = processMaterial(mesh->mMaterialIndex, scene);
+        subMesh.material = m_MaterialHandles[mesh->mMaterialIndex];
+    }
+    return subMesh;
 }
 
 glm::mat4 AiToGlm(const aiMatrix4x4 &from)
@@ -262,10 +307,11 @@ glm::mat4 AiToGlm(const aiMatrix4x4 &from)
 }
 
 // Recursively process nodes
-void Model::processNode(const aiNode *node, const aiScene *scene)
+void Model::processNode(const aiNode *node, const aiScene *scene, int parent)
 {
     Node myNode;
     myNode.name = std::string(node->mName.C_Str());
+    myNode.parent = parent;
     std::string nodeInfo =
         "Node: " + std::string(node->mName.C_Str()) +
         " | m_Meshes: " + std::to_string(node->mNumMeshes) +
@@ -280,16 +326,15 @@ void Model::processNode(const aiNode *node, const aiScene *scene)
     // Process all m_Meshes for this node
     for (unsigned int i = 0; i < node->mNumMeshes; ++i)
     {
-        aiMesh *mesh = scene->mMeshes[node->mMeshes[i]];
-        myNode.meshes.push_back(processMesh(mesh, scene));
-        //  m_Meshes.push_back(std::move(processMesh(mesh, scene)));
+        myNode.meshes.push_back(loadSubMesh(node->mMeshes[i], scene));
     }
 
+    const int index = static_cast<int>(m_Nodes.size());
     m_Nodes.push_back(std::move(myNode));
     // Recursively process each child node
     for (unsigned int i = 0; i < node->mNumChildren; ++i)
     {
-        processNode(node->mChildren[i], scene);
+        processNode(node->mChildren[i], scene, index);
     }
 }
 
@@ -326,22 +371,32 @@ void Model::Render(const shader &Shader, const glm::mat4 &modelMatrix, const glm
     }
 
     // Render each mesh
-    for (size_t i = 0; i < m_Meshes.size(); ++i)
+    const RenderQueue::Pass pass = Shader.getType() == ShaderType::DEPTHSHADER ? RenderQueue::Pass::Shadow : RenderQueue::Pass::Opaque;
+    m_Queue.clear();
+    for (const Node &node : m_Nodes)
     {
-        m_Meshes[i].render(Shader);
+        for (const SubMesh &subMesh : node.meshes)
+        {
+            m_Queue.add(pass, Shader, subMesh, modelMatrix, glm::length(glm::vec3(modelMatrix[3]) - viewPos));
+        }
     }
+    m_Queue.sort();
+    m_Queue.submit();
 }
 
 // Convenience overload that maintains backward compatibility
 void Model::Render(const shader &Shader)
 {
 
-    for (auto node : m_Nodes)
+    const RenderQueue::Pass pass = Shader.getType() == ShaderType::DEPTHSHADER ? RenderQueue::Pass::Shadow : RenderQueue::Pass::Opaque;
+    m_Queue.clear();
+    for (const Node &node : m_Nodes)
     {
-        Shader.setMat4("u_model", node._transform);
-        for (auto mesh : node.meshes)
+        for (const SubMesh &subMesh : node.meshes)
         {
-            mesh.render(Shader);
+            m_Queue.add(pass, Shader, subMesh, node._transform);
         }
     }
+    m_Queue.sort();
+    m_Queue.submit();
 }
\ No newline at end of file
@@ -4,6 +4,8 @@
 #include <assimp/postprocess.h>
 #include "renderer.h"
 #include "Mesh.h"
+#include "AssetRegistry.h"
+#include "RenderQueue.h"
 namespace lgt
 {
 	class Scene;
@@ -13,7 +15,8 @@ struct Node
 {
     std::string name;
 	glm::mat4 _transform;
-	std::vector<Mesh> meshes;
+	int parent = -1; // index in m_Nodes, -1 for the root
+	std::vector<SubMesh> meshes; // handles into AssetRegistry::get()
 };
 
 class Model
@@ -27,14 +30,20 @@ public:
 				const glm::mat4 &projectionMatrix, const glm::vec3 &viewPos, const glm::vec3 &lightPos,
 				const glm::vec3 &lightColor = glm::vec3(1.0f), bool useColor = false,
 				const glm::vec3 &color = glm::vec3(1.0f));
+	RenderQueue &getRenderQueue() { return m_Queue; }
 
 private:
 	std::string m_TextureFilePath;
 	const std::string m_ModelFilepath;
 	std::vector<Node> m_Nodes;
 	std::vector<glm::mat4> m_transforms;
-	std::vector<Mesh> m_Meshes;
+	// registry handles by assimp mesh / material index, so shared ones are loaded once
+	std::vector<MeshHandle> m_MeshHandles;
+	std::vector<MaterialHandle> m_MaterialHandles;
+	RenderQueue m_Queue; // refilled by every Render() call
 	Material LoadMaterial(aiMaterial *M) const;
-	Mesh processMesh(const aiMesh *mesh, const aiScene *scene);
-	void processNode(const aiNode *node, const aiScene *scene);
+	Mesh processMesh(const aiMesh *mesh);
+	MaterialHandle processMaterial(unsigned int index, const aiScene *scene);
+	SubMesh loadSubMesh(unsigned int index, const aiScene *scene);
+	void processNode(const aiNode *node, const aiScene *scene, int parent = -1);
 };
\ No newline at end of file
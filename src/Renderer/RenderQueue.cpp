@@ -0,0 +1,304 @@
+#include "RenderQueue.h"
+#include "GpuCulling.h"
+#include "ecs/Core.h"
+
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+
+static constexpr uint64_t DEPTH_BITS = 20;
+
+// Positive floats order like their bit patterns; keep the top DEPTH_BITS of them.
+static uint64_t quantizeDepth(float depth)
+{
+    if (!(depth > 0.0f))
+        return 0;
+    uint32_t bits;
+    std::memcpy(&bits, &depth, sizeof(bits));
+    return bits >> (31 - DEPTH_BITS);
+}
+
+uint64_t RenderQueue::makeKey(Pass pass, uint8_t shaderIndex, MaterialHandle material, MeshHandle mesh, float depth)
+{
+    const uint64_t passBits     = static_cast<uint64_t>(pass) & 0xF;
+    // slot indices only, the generation does not order anything; InvalidAsset sorts last
+    const uint64_t materialBits = std::min<uint64_t>(assetIndex(material), 0xFFFF);
+    const uint64_t meshBits     = std::min<uint64_t>(assetIndex(mesh), 0xFFFF);
+    const uint64_t depthBits    = quantizeDepth(depth);
+
+    if (pass == Pass::Transparent) {
+        const uint64_t backToFront = ((uint64_t(1) << DEPTH_BITS) - 1) - depthBits;
+        return passBits << 60 | backToFront << 40 | uint64_t(shaderIndex) << 32 | materialBits << 16 | meshBits;
+    }
+    return passBits << 60 | uint64_t(shaderIndex) << 52 | materialBits << 36 | meshBits << 20 | depthBits;
+}
+
+uint8_t RenderQueue::shaderIndex(const shader& Shader)
+{
+    for (size_t i = 0; i < m_Shaders.size(); i++) {
+        if (m_Shaders[i] == &Shader)
+            return static_cast<uint8_t>(i);
+    }
+    LGT_ASSERT_MSG(m_Shaders.size() < 256, "[RenderQueue::shaderIndex] More than 256 shaders in one frame.");
+    m_Shaders.push_back(&Shader);
+    return static_cast<uint8_t>(m_Shaders.size() - 1);
+}
+
+void RenderQueue::add(Pass pass, const shader& Shader, const SubMesh& subMesh, const glm::mat4& transform, float depth)
+{
+    const uint64_t key = makeKey(pass, shaderIndex(Shader), subMesh.material, subMesh.mesh, depth);
+    m_Items.push_back({ key, static_cast<uint32_t>(m_Packets.size()) });
+    m_Packets.push_back({ &Shader, subMesh, transform });
+}
+
+void RenderQueue::sort()
+{
+    const auto start = std::chrono::high_resolution_clock::now();
+    const size_t count = m_Items.size();
+    if (count > 1) {
+        // one read for all eight byte histograms
+        size_t histograms[8][256] = {};
+        for (const SortItem& item : m_Items) {
+            for (int byte = 0; byte < 8; byte++)
+                histograms[byte][(item.key >> (byte * 8)) & 0xFF]++;
+        }
+
+        m_Scratch.resize(count);
+        SortItem* src = m_Items.data();
+        SortItem* dst = m_Scratch.data();
+        for (int byte = 0; byte < 8; byte++) {
+            const int shift = byte * 8;
+            size_t* offsets = histograms[byte];
+            if (offsets[(src[0].key >> shift) & 0xFF] == count)
+                continue; // every key has the same byte here (pass, shader...), nothing to move
+
+            size_t offset = 0;
+            for (int digit = 0; digit < 256; digit++) {
+                const size_t digitCount = offsets[digit];
+                offsets[digit] = offset;
+                offset += digitCount;
+            }
+            for (size_t i = 0; i < count; i++)
+                dst[offsets[(src[i].key >> shift) & 0xFF]++] = src[i];
+            std::swap(src, dst);
+        }
+        if (src != m_Items.data())
+            m_Items.swap(m_Scratch);
+    }
+    m_Stats.sortMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void RenderQueue::buildBatches()
+{
+    const AssetRegistry& assets = AssetRegistry::get();
+    m_Batches.clear();
+    m_Instances.clear();
+    m_Commands.clear();
+    m_InstanceCommands.clear();
+    m_CommandBounds.clear();
+
+    for (uint32_t i = 0; i < m_Items.size(); i++) {
+        const Packet& packet = m_Packets[m_Items[i].packet];
+        // released (stale) handles are dropped rather than drawn with a reused slot
+        if (!assets.isValid(packet.subMesh.mesh)
+            || (packet.subMesh.material != InvalidAsset && !assets.isValidMaterial(packet.subMesh.material)))
+            continue;
+
+        bool extends = false;
+        if (!m_Batches.empty()) {
+            const Batch& last = m_Batches.back();
+            const Packet& first = m_Packets[m_Items[last.firstItem].packet];
+            extends = last.firstItem + last.count == i && first.Shader == packet.Shader
+                   && first.subMesh.material == packet.subMesh.material && first.subMesh.mesh == packet.subMesh.mesh;
+        }
+        if (extends)
+            m_Batches.back().count++;
+        else
+            m_Batches.push_back({ i, 1, static_cast<uint32_t>(m_Instances.size()) });
+
+        if (packet.Shader->isInstanced()) {
+            // the depth shader only reads the model matrix
+            const glm::mat4 normal = packet.Shader->getType() == ShaderType::COLORSHADER
+                ? glm::mat4(glm::transpose(glm::inverse(glm::mat3(packet.transform)))) : glm::mat4(1.0f);
+            m_Instances.push_back({ packet.transform, normal });
+        }
+    }
+
+    // one indirect command per instanced batch, in batch order so a group's commands are contiguous
+    for (Batch& batch : m_Batches) {
+        const Packet& packet = m_Packets[m_Items[batch.firstItem].packet];
+        if (!packet.Shader->isInstanced())
+            continue;
+        const Mesh& mesh = assets.getMesh(packet.subMesh.mesh);
+        batch.command = static_cast<uint32_t>(m_Commands.size());
+        if (m_Culling) {
+            // the GPU counts the visible instances, the range stays reserved for all of them
+            m_Commands.push_back(mesh.getDrawCommand(0, batch.firstInstance));
+            m_InstanceCommands.insert(m_InstanceCommands.end(), batch.count, batch.command);
+            m_CommandBounds.push_back(mesh.getBounds());
+        }
+        else {
+            m_Commands.push_back(mesh.getDrawCommand(batch.count, batch.firstInstance));
+        }
+    }
+}
+
+void RenderQueue::uploadBuffers()
+{
+    if (m_Instances.empty())
+        return;
+
+    const size_t bytes = m_Instances.size() * sizeof(InstanceData);
+    if (m_InstanceBuffer == 0)
+        glGenBuffers(1, &m_InstanceBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_InstanceBuffer);
+    if (bytes > m_InstanceCapacity)
+        m_InstanceCapacity = std::max(bytes, m_InstanceCapacity * 2);
+    // orphan the old storage, the previous submit may still be reading it
+    glBufferData(GL_SHADER_STORAGE_BUFFER, m_InstanceCapacity, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, bytes, m_Instances.data());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, INSTANCE_BINDING, m_InstanceBuffer);
+
+    const size_t commandBytes = m_Commands.size() * sizeof(DrawElementsIndirectCommand);
+    if (m_CommandBuffer == 0)
+        glGenBuffers(1, &m_CommandBuffer);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_CommandBuffer);
+    if (commandBytes > m_CommandCapacity)
+        m_CommandCapacity = std::max(commandBytes, m_CommandCapacity * 2);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, m_CommandCapacity, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, commandBytes, m_Commands.data());
+
+    // instance indices come from the shared VAO's identity attribute
+    GeometryBuffer::get().reserveInstances(m_Instances.size());
+
+    if (m_Culling) {
+        m_Culling->cull(m_InstanceBuffer, m_InstanceCommands, m_CommandBuffer, m_CommandBounds, m_CullViewProjection, m_CullOcclusion);
+        m_Stats.gpuCulled += m_InstanceCommands.size();
+    }
+}
+
+void RenderQueue::submit()
+{
+    buildBatches();
+    uploadBuffers();
+
+    const AssetRegistry& assets = AssetRegistry::get();
+    const shader* boundShader = nullptr;
+    MaterialHandle boundMaterial = InvalidAsset;
+    bool geometryBound = false;
+
+    for (size_t b = 0; b < m_Batches.size();) {
+        const Batch& batch = m_Batches[b];
+        const Packet& packet = m_Packets[m_Items[batch.firstItem].packet];
+        const bool instanced = packet.Shader->isInstanced();
+        // materials only matter to color shaders, a depth pass ignores them
+        const bool colorPass = packet.Shader->getType() == ShaderType::COLORSHADER;
+        const bool usesMaterial = colorPass && packet.subMesh.material != InvalidAsset;
+
+        // instanced : every following batch with the same program (and, in a color pass,
+        // the same material, none included) joins this multi-draw. Otherwise the batch is
+        // drawn packet by packet.
+        size_t end = b + 1;
+        uint32_t packets = batch.count;
+        if (instanced) {
+            for (; end < m_Batches.size(); end++) {
+                const Packet& next = m_Packets[m_Items[m_Batches[end].firstItem].packet];
+                if (next.Shader != packet.Shader || (colorPass && next.subMesh.material != packet.subMesh.material))
+                    break;
+                packets += m_Batches[end].count;
+            }
+        }
+        // every bind below replaces one per packet
+        const size_t saved = packets - 1;
+        const size_t textures = usesMaterial ? assets.getMaterial(packet.subMesh.material).textures.size() : 0;
+
+        // textures are only bound for color shaders, so a new program rebinds the material
+        const bool newShader = packet.Shader != boundShader;
+        if (newShader) {
+            packet.Shader->use();
+            if (instanced)
+                packet.Shader->setBool("u_instanced", true);
+            boundShader = packet.Shader;
+            m_Stats.programBinds++;
+            m_Stats.programBindsSaved += saved;
+        }
+        else {
+            m_Stats.programBindsSaved += packets;
+        }
+
+        if (usesMaterial) {
+            if (newShader || packet.subMesh.material != boundMaterial) {
+                assets.getMaterial(packet.subMesh.material).bind(*packet.Shader);
+                boundMaterial = packet.subMesh.material;
+                m_Stats.materialBinds++;
+                m_Stats.textureBinds += textures;
+                m_Stats.materialBindsSaved += saved;
+                m_Stats.textureBindsSaved += textures * saved;
+            }
+            else {
+                m_Stats.materialBindsSaved += packets;
+                m_Stats.textureBindsSaved += textures * packets;
+            }
+        }
+
+        // all meshes live in the GeometryBuffer VAO
+        const Mesh& mesh = assets.getMesh(packet.subMesh.mesh);
+        if (!geometryBound) {
+            mesh.bind();
+            geometryBound = true;
+            m_Stats.vaoBinds++;
+            m_Stats.vaoBindsSaved += saved;
+        }
+        else {
+            m_Stats.vaoBindsSaved += packets;
+        }
+
+        m_Stats.instances += packets;
+        if (instanced) {
+            const GLsizei commands = static_cast<GLsizei>(end - b);
+            const void* offset = reinterpret_cast<const void*>(static_cast<size_t>(batch.command) * sizeof(DrawElementsIndirectCommand));
+            GlCall(glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, offset, commands, 0));
+            m_Stats.draws++;
+            m_Stats.indirectCommands += commands;
+        }
+        else {
+            for (uint32_t i = batch.firstItem; i < batch.firstItem + batch.count; i++) {
+                packet.Shader->setMat4("u_model", m_Packets[m_Items[i].packet].transform);
+                mesh.submit();
+            }
+            m_Stats.draws += batch.count;
+        }
+        b = end;
+    }
+    GLState::get().bindVertexArray(0);
+
+    // leave the shaders usable for a plain u_model draw outside the queue
+    for (const shader* Shader : m_Shaders) {
+        if (Shader->isInstanced()) {
+            Shader->use();
+            Shader->setBool("u_instanced", false);
+        }
+    }
+}
+
+RenderQueue::~RenderQueue()
+{
+    if (m_InstanceBuffer != 0)
+        glDeleteBuffers(1, &m_InstanceBuffer);
+    if (m_CommandBuffer != 0)
+        glDeleteBuffers(1, &m_CommandBuffer);
+}
+
+void RenderQueue::setCulling(GpuCulling* culling, const glm::mat4& viewProjection, bool occlusion)
+{
+    m_Culling = culling;
+    m_CullViewProjection = viewProjection;
+    m_CullOcclusion = occlusion;
+}
+
+void RenderQueue::clear()
+{
+    m_Packets.clear();
+    m_Items.clear();
+    m_Shaders.clear();
+}
\ No newline at end of file
@@ -0,0 +1,116 @@
+#pragma once
+#include "AssetRegistry.h"
+
+#include <vector>
+#include <cstdint>
+
+class GpuCulling;
+
+// Collects draw packets for a frame, sorts them by a packed 64-bit key and submits them
+// so that consecutive draws share as much GL state as possible.
+// When the shader declares the Instances storage block (see shader::isInstanced), each run
+// of packets with the same mesh becomes one DrawElementsIndirectCommand and all runs that
+// share program and material go out as one glMultiDrawElementsIndirect : a depth pass is
+// one call, a color pass one call per material. Transforms and normal matrices are
+// uploaded to one SSBO per submit and found through baseInstance. With setCulling() the
+// instances are culled on the GPU first (see GpuCulling).
+//
+// Key layout, most significant bits first :
+//   opaque / shadow : pass(4) | shader(8) | material(16) | mesh(16) | depth(20, front to back)
+//   transparent     : pass(4) | depth(20, back to front) | shader(8) | material(16) | mesh(16)
+// A material stands for its whole texture set, so grouping by material groups texture binds.
+// Handles wider than 16 bits only lose sort quality; submit() compares the real handles.
+class RenderQueue {
+public:
+    enum class Pass : uint8_t { Shadow = 0, Opaque = 1, Transparent = 2 };
+
+    // What submit() issued, and what it skipped compared with rebinding per draw.
+    struct Stats {
+        size_t draws = 0;            // GL draw calls
+        size_t instances = 0;        // packets drawn
+        size_t indirectCommands = 0; // commands executed by the multi-draws
+        size_t gpuCulled = 0;        // instances handed to the GPU culler (visibility stays on the GPU)
+        size_t programBinds = 0,  programBindsSaved = 0;
+        size_t materialBinds = 0, materialBindsSaved = 0;
+        size_t textureBinds = 0,  textureBindsSaved = 0;
+        size_t vaoBinds = 0,      vaoBindsSaved = 0;
+        double sortMs = 0.0;
+    };
+
+    // Binding point of the Instances storage block in the shaders.
+    static constexpr GLuint INSTANCE_BINDING = 0;
+
+    RenderQueue() = default;
+    ~RenderQueue();
+    RenderQueue(const RenderQueue&) = delete;
+    RenderQueue& operator=(const RenderQueue&) = delete;
+
+    static uint64_t makeKey(Pass pass, uint8_t shaderIndex, MaterialHandle material, MeshHandle mesh, float depth);
+
+    // depth is the distance to the camera, only used to order draws that share state.
+    void add(Pass pass, const shader& Shader, const SubMesh& subMesh, const glm::mat4& transform, float depth = 0.0f);
+    // Radix sorts the packets by key (stable, 8 bits per pass, constant bytes skipped).
+    void sort();
+    // Issues every packet in key order, binding program / material only on change and
+    // merging runs of identical state into multi-draw indirect calls.
+    // Frame uniforms (view, projection, lights) must already be set on the shaders.
+    void submit();
+    void clear();
+
+    // Culls the instanced draws of every following submit() on the GPU against
+    // viewProjection (and the culler's Hi-Z pyramid when occlusion is set).
+    // Instances of one mesh run may then be drawn in any order. nullptr turns it off.
+    void setCulling(GpuCulling* culling, const glm::mat4& viewProjection = glm::mat4(1.0f), bool occlusion = false);
+
+    size_t size() const { return m_Items.size(); }
+
+    // Stats add up over submits until resetStats(), so several passes make one frame.
+    const Stats& getStats() const { return m_Stats; }
+    void resetStats() { m_Stats = Stats(); }
+
+private:
+    struct Packet {
+        const shader* Shader;
+        SubMesh       subMesh;
+        glm::mat4     transform;
+    };
+    struct SortItem {
+        uint64_t key;
+        uint32_t packet;
+    };
+    // A run of items sharing shader, material and mesh : [firstItem, firstItem + count).
+    struct Batch {
+        uint32_t firstItem;
+        uint32_t count;
+        uint32_t firstInstance; // in m_Instances, instanced shaders only
+        uint32_t command = 0;   // in m_Commands, instanced shaders only
+    };
+    // std430 layout of one element of the Instances block.
+    struct InstanceData {
+        glm::mat4 model;
+        glm::mat4 normal; // mat3 normal matrix in the upper-left 3x3
+    };
+
+    std::vector<Packet>        m_Packets;
+    std::vector<SortItem>      m_Items;
+    std::vector<SortItem>      m_Scratch;
+    std::vector<const shader*> m_Shaders; // index in the key -> shader, rebuilt every frame
+    std::vector<Batch>         m_Batches;
+    std::vector<InstanceData>  m_Instances;
+    std::vector<DrawElementsIndirectCommand> m_Commands;
+    GLuint                     m_InstanceBuffer = 0;
+    size_t                     m_InstanceCapacity = 0; // bytes
+    GLuint                     m_CommandBuffer = 0;
+    size_t                     m_CommandCapacity = 0;  // bytes
+
+    GpuCulling*                m_Culling = nullptr;
+    glm::mat4                  m_CullViewProjection = glm::mat4(1.0f);
+    bool                       m_CullOcclusion = false;
+    std::vector<GLuint>        m_InstanceCommands; // command of each instance, culling only
+    std::vector<glm::vec4>     m_CommandBounds;    // mesh bounding sphere of each command
+    Stats                      m_Stats;
+
+    uint8_t shaderIndex(const shader& Shader);
+    void    buildBatches();
+    void    uploadBuffers();
+};
\ No newline at end of file
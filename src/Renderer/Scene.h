@@ -1,31 +1,100 @@
 #pragma once
 #include "Mesh.h"
+#include "AssetRegistry.h"
+#include "RenderQueue.h"
 #include "renderer.h"
 #include "ecs/ECS.h"
+#include "ecs/Scheduler.h"
+#include "ecs/Hierarchy.h"
 
+#include <cstring>
+
+// Handles into AssetRegistry::get() plus the world matrix; trivially copyable, so any
+// number of entities can share one mesh. Handles are only meaningful in this process
+// (slot + generation of this run's registry), so the component is transient : snapshots
+// leave it out and a loaded scene gets its renderables again from its models.
 struct Renderable
 {
-    std::vector<Mesh> _meshes;
-    glm::mat4 Transform;
+    MeshHandle mesh = InvalidAsset;         // InvalidAsset : nothing to draw (e.g. a pivot node)
+    MaterialHandle material = InvalidAsset;
+    glm::mat4 Transform; // world matrix, written by the scene's TransformHierarchy
 };
-LGT_REGISTER_COMPONENT(lgt, Renderable);
+LGT_REGISTER_TRANSIENT_COMPONENT(lgt, Renderable);
+
+// lgt::Mat4 and glm::mat4 are both 16 column-major floats
+static_assert(sizeof(lgt::Mat4) == sizeof(glm::mat4), "Mat4 / glm::mat4 layout mismatch");
+
+inline lgt::Mat4 toMat4(const glm::mat4 &m)
+{
+    lgt::Mat4 out;
+    std::memcpy(out.m, glm::value_ptr(m), sizeof(out.m));
+    return out;
+}
+
+inline glm::mat4 toGlm(const lgt::Mat4 &m)
+{
+    glm::mat4 out;
+    std::memcpy(glm::value_ptr(out), m.m, sizeof(m.m));
+    return out;
+}
 
 namespace lgt
 {
     class Scene
     {
     public:
-        void Render(const shader &Shader)
+        // Queues every Renderable and submits them sorted by shader / material / mesh;
+        // viewPos orders draws that share all three front to back.
+        void Render(const shader &Shader, const glm::vec3 &viewPos = glm::vec3(0.0f))
         {
-            for (auto e : m_Entites)
+            const RenderQueue::Pass pass = Shader.getType() == ShaderType::DEPTHSHADER ? RenderQueue::Pass::Shadow : RenderQueue::Pass::Opaque;
+            m_RenderQueue.clear();
+            // read-only, so drawing never marks the Renderables changed
+            m_Roster->view<const Renderable>().each([&](const Renderable &component)
             {
-                auto &component = e.getComponent<Renderable>();
-                Shader.setMat4("u_model", component.Transform);
-                for (auto &mesh : component._meshes)
-                {
-                    mesh.render(Shader);
-                }
-            }
+                if (component.mesh == InvalidAsset)
+                    return;
+                const float depth = glm::length(glm::vec3(component.Transform[3]) - viewPos);
+                m_RenderQueue.add(pass, Shader, { component.mesh, component.material }, component.Transform, depth);
+            });
+            m_RenderQueue.sort();
+            m_RenderQueue.submit();
+        }
+
+        RenderQueue &getRenderQueue()
+        {
+            return m_RenderQueue;
+        }
+
+        // Runs every registered system for this frame, then propagates the transforms
+        // that moved and copies the new world matrices into the Renderables.
+        void Update(float deltaTime)
+        {
+            m_Scheduler->run(deltaTime);
+
+            if (m_Hierarchy.update() == 0)
+                return;
+            m_Hierarchy.eachChanged([this](EntityHandle handle, const Mat4 &world)
+            {
+                Entity entity(handle, m_Roster.get(), "");
+                if (entity.hasComponent<Renderable>())
+                    entity.getComponent<Renderable>().Transform = toGlm(world);
+            });
+        }
+
+        TransformHierarchy &getHierarchy()
+        {
+            return m_Hierarchy;
+        }
+
+        Roster &getRoster()
+        {
+            return *m_Roster;
+        }
+
+        Scheduler &getScheduler()
+        {
+            return *m_Scheduler;
         }
 
         const std::vector<Entity> getEntites()
@@ -63,12 +132,21 @@ namespace lgt
 
                         ImGuizmo::SetRect(ImGui::GetWindowPos().x, ImGui::GetWindowPos().y, windowwidth, windowheight);
 
+                        glm::mat4 &world = entity.getComponent<Renderable>().Transform;
                         ImGuizmo::Manipulate(
                             glm::value_ptr(view),
                             glm::value_ptr(proj),
                             operation,
                             ImGuizmo::LOCAL,
-                            glm::value_ptr(entity.getComponent<Renderable>().Transform));
+                            glm::value_ptr(world));
+
+                        // the gizmo edits the world matrix, the hierarchy stores it relative to the parent
+                        if (ImGuizmo::IsUsing() && m_Hierarchy.contains(entity.getHandle()))
+                        {
+                            const EntityHandle parent = m_Hierarchy.getParent(entity.getHandle());
+                            const glm::mat4 parentWorld = parent != NullEntity ? toGlm(m_Hierarchy.getWorld(parent)) : glm::mat4(1.0f);
+                            m_Hierarchy.setLocal(entity.getHandle(), toMat4(glm::inverse(parentWorld) * world));
+                        }
                     }
 
                     // Right-click context menu
@@ -88,11 +166,15 @@ namespace lgt
         Scene()
         {
             m_Roster = std::make_unique<Roster>();
+            m_Scheduler = std::make_unique<Scheduler>(*m_Roster);
         }
 
     private:
-        EntityHandle m_Selcted;
+        EntityHandle m_Selcted = NullEntity;
         Scope<Roster> m_Roster;
+        Scope<Scheduler> m_Scheduler;
+        TransformHierarchy m_Hierarchy;
+        RenderQueue m_RenderQueue;
         std::vector<Entity> m_Entites;
 
         friend Model;
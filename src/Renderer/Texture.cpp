@@ -35,7 +35,7 @@ Texture::Texture(const std::string& filepath) :
 	}
 
 	glGenTextures(1, &m_RenderID);
-	glBindTexture(GL_TEXTURE_2D, m_RenderID);
+	GLState::get().bindTexture(m_RenderID);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
@@ -44,7 +44,7 @@ Texture::Texture(const std::string& filepath) :
 
 	glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, m_width, m_height, 0, dataFormat, GL_UNSIGNED_BYTE, m_localbuffer);
 
-	glBindTexture(GL_TEXTURE_2D, 0);
+	GLState::get().bindTexture(0);
 
 	stbi_image_free(m_localbuffer);
 }
@@ -55,19 +55,19 @@ GLuint Texture::GetTextureID()
 void  Texture::cleanUp()
 {
 	LOG(LogLevel::DEBUG, "Deleting Texture ID: " + std::to_string(m_RenderID));
+	GLState::get().onTextureDeleted(m_RenderID);
 	glDeleteTextures(1, &m_RenderID);
 	LOG(LogLevel::DEBUG, "Texture deleted");
 }
 
 void Texture::Bind(unsigned int slot) const
 {   
-		glActiveTexture(GL_TEXTURE0+slot);
- 		glBindTexture(GL_TEXTURE_2D, m_RenderID);
+		GLState::get().bindTexture(slot, m_RenderID);
  }
 
 void Texture::Unbind() const 
 {
-	glBindTexture(GL_TEXTURE_2D,0);
+	GLState::get().bindTexture(0);
 }
 
 void Texture::setType(TextureType type)
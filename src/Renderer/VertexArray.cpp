@@ -8,6 +8,7 @@ VertexArray::VertexArray()
 
 VertexArray::~VertexArray()
 {
+	GLState::get().onVertexArrayDeleted(m_RenderID);
 	glDeleteVertexArrays(1,&m_RenderID);
 
 }
@@ -29,10 +30,10 @@ const void VertexArray::AddLayout(const  BufferLayout& layout,const VertexBuffer
 
 const void VertexArray::Bind() const
 {
-	glBindVertexArray(m_RenderID);
+	GLState::get().bindVertexArray(m_RenderID);
 }
 
 const void VertexArray::Unbind() const
 {
-	glBindVertexArray(0);
+	GLState::get().bindVertexArray(0);
 }
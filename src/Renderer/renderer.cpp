@@ -60,7 +60,7 @@
         glGenBuffers(1, &m_VBO);
         glGenBuffers(1, &m_EBO);
 
-        glBindVertexArray(m_VAO);
+        GLState::get().bindVertexArray(m_VAO);
 
         // Vertex buffer
         glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
@@ -76,7 +76,7 @@
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
         glEnableVertexAttribArray(0);
 
-        glBindVertexArray(0);
+        GLState::get().bindVertexArray(0);
     }
 
     void Grid::render(camera& cam, float deltaTime) {
@@ -85,11 +85,12 @@
         m_time += deltaTime;
 
         // Enable blending for transparency
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        GLState& state = GLState::get();
+        state.setEnabled(GL_BLEND, true);
+        state.blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
         // Disable depth writing but keep depth testing
-        glDepthMask(GL_FALSE);
+        state.depthMask(false);
 
         // Use RAII shader binding
         shader::ScopedBind shaderBind(*m_gridShader);
@@ -118,13 +119,13 @@
         m_gridShader->setBool("u_enableGradient", m_settings.enableGradient);
 
         // Render the mesh
-        glBindVertexArray(m_VAO);
+        state.bindVertexArray(m_VAO);
         glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(m_indices.size()), GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0);
+        state.bindVertexArray(0);
 
         // Restore render state
-        glDepthMask(GL_TRUE);
-        glDisable(GL_BLEND);
+        state.depthMask(true);
+        state.setEnabled(GL_BLEND, false);
     }
 
     GridSettings& Grid::getSetting()
@@ -134,6 +135,7 @@
 
     void Grid::cleanup() {
         if (m_VAO) {
+            GLState::get().onVertexArrayDeleted(m_VAO);
             glDeleteVertexArrays(1, &m_VAO);
             glDeleteBuffers(1, &m_VBO);
             glDeleteBuffers(1, &m_EBO);
@@ -150,7 +152,7 @@ renderer::renderer()
     , m_currentRenderMode(RenderMode::FILL)
 {
     // Enable depth testing by default
-    glEnable(GL_DEPTH_TEST);
+    GLState::get().setEnabled(GL_DEPTH_TEST, true);
 
     logGlVersion();
 }
@@ -269,27 +271,20 @@ void renderer::setRenderMode(RenderMode mode) {
 }
 
 void renderer::enableDepthTesting(bool enable) {
-    if (enable) {
-        GlCall(glEnable(GL_DEPTH_TEST));
-    }
-    else {
-        GlCall(glDisable(GL_DEPTH_TEST));
-    }
+    GlCall(GLState::get().setEnabled(GL_DEPTH_TEST, enable));
 }
 
 void renderer::enableBlending(bool enable) {
+    GLState& state = GLState::get();
+    GlCall(state.setEnabled(GL_BLEND, enable));
     if (enable) {
-        GlCall(glEnable(GL_BLEND));
-        GlCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
-    }
-    else {
-        GlCall(glDisable(GL_BLEND));
+        GlCall(state.blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
     }
 }
 
 void renderer::setViewport(int width, int height) {
     if (width > 0 && height > 0) {
-        GlCall(glViewport(0, 0, width, height));
+        GlCall(GLState::get().setViewport(0, 0, width, height));
     }
 }
 
@@ -311,7 +306,7 @@ void renderer::Initauad() {
 
     glGenVertexArrays(1, &quadVAO);
     glGenBuffers(1, &quadVBO);
-    glBindVertexArray(quadVAO);
+    GLState::get().bindVertexArray(quadVAO);
 
     glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), quadVertices, GL_STATIC_DRAW);
@@ -322,13 +317,13 @@ void renderer::Initauad() {
     glEnableVertexAttribArray(1);
     glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
 
-    glBindVertexArray(0);
+    GLState::get().bindVertexArray(0);
 }
 
 void renderer::renderQuad(){
-    glBindVertexArray(quadVAO);
+    GLState::get().bindVertexArray(quadVAO);
     glDrawArrays(GL_TRIANGLES, 0, 6);
-    glBindVertexArray(0);
+    GLState::get().bindVertexArray(0);
 }
 
 //-------------------------------------------------
@@ -338,6 +333,11 @@ RenderId FrameBuffer::GetTextureId()
     return m_textureId;
 }
 
+RenderId FrameBuffer::GetDepthTextureId()
+{
+    return m_depthTextureId;
+}
+
 RenderId FrameBuffer::GetHeight()
 {
     return m_height;
@@ -350,45 +350,50 @@ RenderId FrameBuffer::GetWidth()
 //
 void FrameBuffer::Use()
 {
-    GlCall(glViewport(0,0,m_width,m_height));
-    GlCall(glBindFramebuffer(GL_FRAMEBUFFER ,m_FBO));
+    GlCall(GLState::get().setViewport(0,0,m_width,m_height));
+    GlCall(GLState::get().bindFramebuffer(m_FBO));
 }
 
 void FrameBuffer::Unuse()
 {
-    GlCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+    GlCall(GLState::get().bindFramebuffer(0));
 }
 
 FrameBuffer::FrameBuffer( float w , float h) :
     m_width(w) , m_height(h)
 {
    GlCall(glGenFramebuffers(1, &m_FBO));
-   GlCall(glBindFramebuffer(GL_FRAMEBUFFER, m_FBO));
+   GlCall(GLState::get().bindFramebuffer(m_FBO));
    
    GlCall(glGenTextures(1, &m_textureId));
-   GlCall(glBindTexture(GL_TEXTURE_2D, m_textureId));
+   GlCall(GLState::get().bindTexture(m_textureId));
    GlCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_width, m_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
    GlCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
    GlCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
    
    GlCall(glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, m_textureId, 0));
 
-   GlCall(glGenRenderbuffers(1, &m_renderbuffer));
-   GlCall(glBindRenderbuffer(GL_RENDERBUFFER, m_renderbuffer));
+   GlCall(glGenTextures(1, &m_depthTextureId));
+   GlCall(GLState::get().bindTexture(m_depthTextureId));
   
-   GlCall(glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, m_width, m_height));
-   GlCall(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_renderbuffer));
+   GlCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, m_width, m_height, 0, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, nullptr));
+   GlCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+   GlCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+   GlCall(glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, m_depthTextureId, 0));
 
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
         LOG_ERROR("FRAMEBUFFER:: Not complete!\n");
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLState::get().bindFramebuffer(0);
 }
 
 FrameBuffer::~FrameBuffer()
 {
+    GLState::get().onFramebufferDeleted(m_FBO);
+    GLState::get().onTextureDeleted(m_textureId);
+    GLState::get().onTextureDeleted(m_depthTextureId);
     glDeleteFramebuffers(1, &m_FBO);
-    glDeleteRenderbuffers(1, &m_renderbuffer);
+    glDeleteTextures(1, &m_depthTextureId);
     glDeleteTextures(1, &m_textureId);
 }
 
@@ -397,11 +402,11 @@ FrameBuffer::~FrameBuffer()
 DepthBuffer::DepthBuffer()
 {
     GlCall(glGenFramebuffers(1, &m_BufferId));
-    GlCall(glBindFramebuffer(GL_FRAMEBUFFER, m_BufferId));
+    GlCall(GLState::get().bindFramebuffer(m_BufferId));
 
     // Generate depth texture
     GlCall(glGenTextures(1, &m_textureId));
-    GlCall(glBindTexture(GL_TEXTURE_2D, m_textureId));
+    GlCall(GLState::get().bindTexture(m_textureId));
     GlCall(glTexImage2D(
         GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT16,
         (GLsizei)SHADOW_WIDTH, (GLsizei)SHADOW_HEIGHT, 0,
@@ -426,42 +431,43 @@ DepthBuffer::DepthBuffer()
         std::cerr << "ERROR: Depth framebuffer not complete!" << std::endl;
     }
 
-    GlCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+    GlCall(GLState::get().bindFramebuffer(0));
 }
 
 DepthBuffer::~DepthBuffer()
 {
+   GLState::get().onFramebufferDeleted(m_BufferId);
+   GLState::get().onTextureDeleted(m_textureId);
    GlCall( glDeleteFramebuffers(1, &m_BufferId));
    GlCall( glDeleteTextures(1, &m_textureId));
 }
 
 void DepthBuffer::Use()
 {
-    GlCall(glViewport( 0 ,0 ,SHADOW_WIDTH, SHADOW_HEIGHT));
-    GlCall(glBindFramebuffer(GL_FRAMEBUFFER,m_BufferId));
+    GlCall(GLState::get().setViewport( 0 ,0 ,SHADOW_WIDTH, SHADOW_HEIGHT));
+    GlCall(GLState::get().bindFramebuffer(m_BufferId));
 }
 void DepthBuffer::Unsue()
 {
-    GlCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+    GlCall(GLState::get().bindFramebuffer(0));
 }
 
 void DepthBuffer::Bind()
 {
-    GlCall(glBindFramebuffer(GL_FRAMEBUFFER, m_BufferId));
+    GlCall(GLState::get().bindFramebuffer(m_BufferId));
 }
 void DepthBuffer::UnBind()
 {
-    GlCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+    GlCall(GLState::get().bindFramebuffer(0));
 }
 
 void DepthBuffer::BindTex(unsigned int slot)
 {
-    GlCall(glActiveTexture(GL_TEXTURE0 + slot));
-    GlCall(glBindTexture(GL_TEXTURE_2D, m_textureId));
+    GlCall(GLState::get().bindTexture(slot, m_textureId));
 }
 void DepthBuffer::UnBindTex()
 {
-    GlCall(glBindTexture(GL_TEXTURE_2D, 0));
+    GlCall(GLState::get().bindTexture(0));
 }
 
 RenderId DepthBuffer::GetTextureId()
@@ -21,6 +21,7 @@
 #include <glm/gtx/matrix_decompose.hpp>
 
 #include"Logger.h"
+#include"GLState.h"
 #include"VertexBuffer.h"
 #include"IndexBuffer.h"
 #include"VertexArray.h"
@@ -74,10 +75,11 @@ private:
 
     RenderId m_FBO;
     RenderId m_textureId;
-    RenderId m_renderbuffer;
+    RenderId m_depthTextureId; // depth-stencil as a texture, so Hi-Z can be built from it
 
 public:
     RenderId GetTextureId();
+    RenderId GetDepthTextureId();
     RenderId GetHeight();
     RenderId GetWidth();
     void Use();
@@ -1,13 +1,14 @@
 #include "renderer.h"
 #include "shader.h"
 #include "camera.h"
+#include "ecs/Core.h"
 #include <unordered_map>
 
 shader::shader(const std::string& filepath)
     : m_filepath(filepath), m_RenderID(0)
 {
     shadersource source = parseShader(filepath);
-    m_RenderID = createShader(source.vertexSource, source.fragmentSource);
+    m_RenderID = createProgram(source);
 
     // Cache uniform locations for better performance
     cacheUniformLocations();
@@ -19,7 +20,7 @@ shader::shader(const std::string& filepath ,ShaderType type )
     : m_filepath(filepath), m_RenderID(0) ,m_type(type)
 {
     shadersource source = parseShader(filepath);
-    m_RenderID = createShader(source.vertexSource, source.fragmentSource);
+    m_RenderID = createProgram(source);
 
     // Cache uniform locations for better performance
     cacheUniformLocations();
@@ -29,18 +30,19 @@ shader::shader(const std::string& filepath ,ShaderType type )
 
 shader::~shader()
 {
+    GLState::get().onProgramDeleted(m_RenderID);
     glDeleteProgram(m_RenderID);
     LOG(LogLevel::_IMP, "Shader deleted | ID: " + std::to_string(m_RenderID));
 }
 
 void shader::use() const
 {
-    glUseProgram(m_RenderID);
+    GLState::get().useProgram(m_RenderID);
 }
 
 void shader::useWithCamera(camera& Camera)
 {
-    glUseProgram(m_RenderID);
+    GLState::get().useProgram(m_RenderID);
     setMat4("u_view", Camera.GetViewMatrix());
     setMat4("u_projection", Camera.GetProjectionMatrix());
     setVec3("u_viewPos", Camera.GetCameraPos());
@@ -48,7 +50,14 @@ void shader::useWithCamera(camera& Camera)
 
 void shader::unuse() const
 {
-    glUseProgram(0);
+    GLState::get().useProgram(0);
+}
+
+void shader::dispatch(GLuint groupsX, GLuint groupsY, GLuint groupsZ) const
+{
+    LGT_ASSERT_MSG(m_type == ShaderType::COMPUTESHADER, "[shader::dispatch] Not a compute program.");
+    use();
+    GlCall(glDispatchCompute(groupsX, groupsY, groupsZ));
 }
 
 shadersource shader::parseShader(const std::string& filepath)
@@ -58,13 +67,13 @@ shadersource shader::parseShader(const std::string& filepath)
 
     if (!stream.is_open()) {
         LOG(LogLevel::_ERROR, "Failed to open shader file: " + filepath);
-        return { "", "" };
+        return { "", "", "" };
     }
 
     std::string line;
-    std::stringstream ss[2];
+    std::stringstream ss[3];
 
-    enum class ShaderType { NONE = -1, VERTEX = 0, FRAGMENT = 1 };
+    enum class ShaderType { NONE = -1, VERTEX = 0, FRAGMENT = 1, COMPUTE = 2 };
     ShaderType type = ShaderType::NONE;
 
     while (getline(stream, line)) {
@@ -73,13 +82,15 @@ shadersource shader::parseShader(const std::string& filepath)
                 type = ShaderType::VERTEX;
             else if (line.find("Fragment") != std::string::npos)
                 type = ShaderType::FRAGMENT;
+            else if (line.find("Compute") != std::string::npos)
+                type = ShaderType::COMPUTE;
         }
         else if (type != ShaderType::NONE) {
             ss[static_cast<int>(type)] << line << "\n";
         }
     }
 
-    return { ss[0].str(), ss[1].str() };
+    return { ss[0].str(), ss[1].str(), ss[2].str() };
 }
 
 unsigned int shader::compileShader(unsigned int type, const std::string& source)
@@ -99,14 +110,14 @@ unsigned int shader::compileShader(unsigned int type, const std::string& source)
         std::vector<char> errorLog(length);
         glGetShaderInfoLog(id, length, &length, errorLog.data());
 
-        std::string shaderTypeStr = (type == GL_VERTEX_SHADER) ? "Vertex" : "Fragment";
+        std::string shaderTypeStr = (type == GL_VERTEX_SHADER) ? "Vertex" : (type == GL_COMPUTE_SHADER) ? "Compute" : "Fragment";
         LOG(LogLevel::_ERROR, shaderTypeStr + " shader compilation error: " + std::string(errorLog.data()));
 
         glDeleteShader(id);
         return 0;
     }
     else {
-        std::string shaderTypeStr = (type == GL_VERTEX_SHADER) ? "Vertex" : "Fragment";
+        std::string shaderTypeStr = (type == GL_VERTEX_SHADER) ? "Vertex" : (type == GL_COMPUTE_SHADER) ? "Compute" : "Fragment";
         LOG(LogLevel::DEBUG, shaderTypeStr + " shader compiled successfully.");
     }
 
@@ -164,14 +175,58 @@ unsigned int shader::createShader(const std::string& vertexShader, const std::st
     return program;
 }
 
+unsigned int shader::createComputeShader(const std::string& computeShader)
+{
+    unsigned int program = glCreateProgram();
+    unsigned int cs = compileShader(GL_COMPUTE_SHADER, computeShader);
+    if (cs == 0) {
+        LOG(LogLevel::_ERROR, "Compute shader compilation failed, cannot create program");
+        glDeleteProgram(program);
+        return 0;
+    }
+
+    glAttachShader(program, cs);
+    glLinkProgram(program);
+    glDeleteShader(cs);
+
+    int success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        int length;
+        glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+
+        std::vector<char> errorLog(length);
+        glGetProgramInfoLog(program, length, &length, errorLog.data());
+
+        LOG(LogLevel::_ERROR, "Compute program linking error: " + std::string(errorLog.data()));
+        glDeleteProgram(program);
+        return 0;
+    }
+
+    LOG(LogLevel::_IMP, "Compute program linked successfully | Program ID: " + std::to_string(program));
+    return program;
+}
+
+unsigned int shader::createProgram(const shadersource& source)
+{
+    if (!source.computeSource.empty()) {
+        m_type = ShaderType::COMPUTESHADER;
+        return createComputeShader(source.computeSource);
+    }
+    return createShader(source.vertexSource, source.fragmentSource);
+}
+
 void shader::cacheUniformLocations()
 {
     if (m_RenderID == 0) return;
 
+    m_instanced = glGetProgramResourceIndex(m_RenderID, GL_SHADER_STORAGE_BLOCK, "Instances") != GL_INVALID_INDEX;
+
     // Common uniforms that we'll cache for performance
     std::vector<std::string> commonUniforms = {
         // Matrices
         "u_model", "u_view", "u_projection", "u_normalMatrix",
+        "u_instanced",
 
         // Material properties
         "u_material.ambient", "u_material.diffuse", "u_material.specular",
@@ -376,13 +431,14 @@ bool shader::isValid() const {
 
 void shader::reload() {
     if (m_RenderID != 0) {
+        GLState::get().onProgramDeleted(m_RenderID);
         glDeleteProgram(m_RenderID);
     }
 
     LOG(LogLevel::_IMP, "Reloading shader from: " + m_filepath);
 
     shadersource source = parseShader(m_filepath);
-    m_RenderID = createShader(source.vertexSource, source.fragmentSource);
+    m_RenderID = createProgram(source);
 
     if (m_RenderID != 0) {
         // Clear and recache uniform locations
@@ -428,4 +484,9 @@ shader::ScopedBind::~ScopedBind() {
 ShaderType shader::getType() const
 {
     return m_type;
+}
+
+bool shader::isInstanced() const
+{
+    return m_instanced;
 }
\ No newline at end of file
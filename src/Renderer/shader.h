@@ -13,12 +13,14 @@ struct Material;
 
 enum ShaderType {
     DEPTHSHADER ,
-    COLORSHADER
+    COLORSHADER ,
+    COMPUTESHADER // set automatically for files with a #shader Compute section
 };
 
 struct shadersource {
     std::string vertexSource;
     std::string fragmentSource;
+    std::string computeSource;
 };
 
 class shader {
@@ -26,12 +28,15 @@ private:
     std::string m_filepath;
     GLuint m_RenderID;
     ShaderType m_type  = ShaderType::COLORSHADER;
+    bool m_instanced = false;
     mutable std::unordered_map<std::string, int> m_uniformLocationCache;
 
     // Helper methods
     shadersource parseShader(const std::string& filepath);
     unsigned int compileShader(unsigned int type, const std::string& source);
     unsigned int createShader(const std::string& vertexShader, const std::string& fragmentShader);
+    unsigned int createComputeShader(const std::string& computeShader);
+    unsigned int createProgram(const shadersource& source);
     void cacheUniformLocations();
     int getUniformLocation(const std::string& name) const;
 
@@ -50,6 +55,7 @@ public:
     shader(shader&& other) noexcept
         : m_filepath(std::move(other.m_filepath))
         , m_RenderID(other.m_RenderID)
+        , m_instanced(other.m_instanced)
         , m_uniformLocationCache(std::move(other.m_uniformLocationCache))
     {
         other.m_RenderID = 0;
@@ -58,11 +64,13 @@ public:
     shader& operator=(shader&& other) noexcept {
         if (this != &other) {
             if (m_RenderID != 0) {
+                GLState::get().onProgramDeleted(m_RenderID);
                 glDeleteProgram(m_RenderID);
             }
 
             m_filepath = std::move(other.m_filepath);
             m_RenderID = other.m_RenderID;
+            m_instanced = other.m_instanced;
             m_uniformLocationCache = std::move(other.m_uniformLocationCache);
 
             other.m_RenderID = 0;
@@ -74,6 +82,8 @@ public:
     void use() const;
     void useWithCamera(camera& Camera);
     void unuse() const;
+    // Compute programs only : use() then glDispatchCompute. Barriers are up to the caller.
+    void dispatch(GLuint groupsX, GLuint groupsY = 1, GLuint groupsZ = 1) const;
 
     // Modern uniform setting methods
     void setBool(const std::string& name, bool value) const;
@@ -123,6 +133,9 @@ public:
     // Utility methods
     GLuint getID() const;
     ShaderType getType() const ;
+    // Declares the Instances storage block : RenderQueue draws it instanced, with
+    // u_instanced selecting the per-instance transforms.
+    bool isInstanced() const;
     const std::string& getPath() const;
     bool isValid() const;
     void reload();
@@ -44,10 +44,11 @@ MAIN
 	ImGui_ImplOpenGL3_Init("# version 450");
     
 	//gl settings
-	glEnable(GL_CULL_FACE);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	glEnable(GL_DEPTH_TEST);
+	GLState& state = GLState::get();
+	state.setEnabled(GL_CULL_FACE, true);
+    state.setEnabled(GL_BLEND, true);
+    state.blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	state.setEnabled(GL_DEPTH_TEST, true);
 	
 	Logger::GetInstance().SetLogFile("log.txt");
 	LOG(LogLevel::DEBUG, "every one is also fuckef up in there own way");
@@ -0,0 +1,917 @@
+// Standalone ECS benchmark / stress harness. No window, no GL.
+//
+//   EcsBench [--quick] [--filter <substr>] [--out <file.json>] [--baseline <file.json>] [--threshold <pct>]
+//
+// Every case prints one JSON object per line inside {"benchmarks":[...]} so results can be
+// diffed or fed back with --baseline, which prints the change in ns/op per case and
+// returns 1 when a case got slower than the threshold (default 10%).
+// Cases also check their results; any failed check makes the run return 1.
+
+#include "ecs/ECS.h"
+#include "ecs/CommandBuffer.h"
+#include "ecs/EntityLocations.h"
+#include "ecs/Hierarchy.h"
+#include "ecs/Snapshot.h"
+#include "ecs/Scheduler.h"
+#include "helpers/JobSystem.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// ==================== Allocation tracking ====================
+// Every global new/delete goes through here so a case can report allocations per
+// operation and the peak number of live heap bytes.
+
+namespace {
+
+    std::atomic<size_t> g_AllocCount{ 0 };
+    std::atomic<size_t> g_AllocBytes{ 0 };
+    std::atomic<size_t> g_LiveBytes{ 0 };
+    std::atomic<size_t> g_PeakBytes{ 0 };
+
+    struct AllocHeader {
+        void*  raw;
+        size_t size;
+    };
+
+    void* trackedAlloc(size_t size, size_t align) {
+        align = std::max(align, alignof(AllocHeader));
+        void* raw = std::malloc(size + align + sizeof(AllocHeader));
+        if (!raw) throw std::bad_alloc();
+
+        const uintptr_t base = reinterpret_cast<uintptr_t>(raw) + sizeof(AllocHeader);
+        const uintptr_t aligned = (base + align - 1) & ~(uintptr_t(align) - 1);
+        reinterpret_cast<AllocHeader*>(aligned)[-1] = { raw, size };
+
+        g_AllocCount.fetch_add(1, std::memory_order_relaxed);
+        g_AllocBytes.fetch_add(size, std::memory_order_relaxed);
+        const size_t live = g_LiveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+        size_t peak = g_PeakBytes.load(std::memory_order_relaxed);
+        while (live > peak && !g_PeakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    void trackedFree(void* ptr) {
+        if (!ptr) return;
+        const AllocHeader header = static_cast<AllocHeader*>(ptr)[-1];
+        g_LiveBytes.fetch_sub(header.size, std::memory_order_relaxed);
+        std::free(header.raw);
+    }
+
+} // namespace
+
+void* operator new(size_t size) { return trackedAlloc(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void* operator new[](size_t size) { return trackedAlloc(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void* operator new(size_t size, std::align_val_t align) { return trackedAlloc(size, static_cast<size_t>(align)); }
+void* operator new[](size_t size, std::align_val_t align) { return trackedAlloc(size, static_cast<size_t>(align)); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { try { return trackedAlloc(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); } catch (...) { return nullptr; } }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { try { return trackedAlloc(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); } catch (...) { return nullptr; } }
+void operator delete(void* ptr) noexcept { trackedFree(ptr); }
+void operator delete[](void* ptr) noexcept { trackedFree(ptr); }
+void operator delete(void* ptr, size_t) noexcept { trackedFree(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { trackedFree(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { trackedFree(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { trackedFree(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { trackedFree(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { trackedFree(ptr); }
+
+// ==================== Harness ====================
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    struct Options {
+        bool        quick = false;
+        std::string filter;
+        std::string out;
+        std::string baseline;
+        double      threshold = 10.0; // percent
+    };
+
+    struct Result {
+        std::string name;
+        size_t      ops = 0;
+        double      nsPerOp = 0.0;
+        double      allocsPerOp = 0.0;
+        double      bytesPerOp = 0.0;
+        size_t      peakBytes = 0;
+    };
+
+    Options             g_Options;
+    std::vector<Result> g_Results;
+    size_t              g_Failures = 0;
+
+    bool check(bool condition, const std::string& what) {
+        if (!condition) {
+            std::fprintf(stderr, "CHECK FAILED: %s\n", what.c_str());
+            g_Failures++;
+        }
+        return condition;
+    }
+
+    bool selected(const std::string& name) {
+        return g_Options.filter.empty() || name.find(g_Options.filter) != std::string::npos;
+    }
+
+    // Runs body once as warm-up, then `repeats` measured times and keeps the fastest
+    // run. body(ops) does the work and must set ops to the number of operations done;
+    // setup runs before each run and is not timed.
+    void bench(const std::string& name, int repeats, const std::function<void()>& setup,
+        const std::function<void(size_t&)>& body, const std::function<void()>& teardown = {})
+    {
+        if (!selected(name))
+            return;
+
+        Result best;
+        best.name = name;
+        best.nsPerOp = 1e300;
+        for (int run = 0; run <= repeats; run++) {
+            if (setup) setup();
+
+            const size_t allocs = g_AllocCount.load();
+            const size_t bytes = g_AllocBytes.load();
+            g_PeakBytes.store(g_LiveBytes.load());
+
+            size_t ops = 0;
+            const auto begin = Clock::now();
+            body(ops);
+            const auto end = Clock::now();
+
+            const double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+            const double perOp = ns / static_cast<double>(std::max<size_t>(ops, 1));
+            if (run > 0 && perOp < best.nsPerOp) {
+                best.ops = ops;
+                best.nsPerOp = perOp;
+                best.allocsPerOp = static_cast<double>(g_AllocCount.load() - allocs) / std::max<size_t>(ops, 1);
+                best.bytesPerOp = static_cast<double>(g_AllocBytes.load() - bytes) / std::max<size_t>(ops, 1);
+                best.peakBytes = g_PeakBytes.load();
+            }
+            if (teardown) teardown();
+        }
+        g_Results.push_back(best);
+        std::fprintf(stderr, "%-44s %12.2f ns/op %10.4f allocs/op %12zu peak bytes\n",
+            best.name.c_str(), best.nsPerOp, best.allocsPerOp, best.peakBytes);
+    }
+
+    std::string toJson(const Result& r) {
+        char line[512];
+        std::snprintf(line, sizeof(line),
+            "{\"name\":\"%s\",\"ops\":%zu,\"ns_per_op\":%.4f,\"allocs_per_op\":%.6f,\"bytes_per_op\":%.4f,\"peak_bytes\":%zu}",
+            r.name.c_str(), r.ops, r.nsPerOp, r.allocsPerOp, r.bytesPerOp, r.peakBytes);
+        return line;
+    }
+
+    std::string n(size_t count) {
+        if (count >= 1000000 && count % 1000000 == 0) return std::to_string(count / 1000000) + "M";
+        if (count >= 1000 && count % 1000 == 0) return std::to_string(count / 1000) + "k";
+        return std::to_string(count);
+    }
+
+    // Reads "name" -> ns_per_op back from a file this harness wrote (one case per line).
+    std::map<std::string, double> loadBaseline(const std::string& path) {
+        std::map<std::string, double> values;
+        std::ifstream file(path);
+        std::string line;
+        while (std::getline(file, line)) {
+            const size_t name = line.find("\"name\":\"");
+            const size_t ns = line.find("\"ns_per_op\":");
+            if (name == std::string::npos || ns == std::string::npos) continue;
+            const size_t nameBegin = name + 8;
+            const size_t nameEnd = line.find('"', nameBegin);
+            values[line.substr(nameBegin, nameEnd - nameBegin)] = std::atof(line.c_str() + ns + 12);
+        }
+        return values;
+    }
+
+    // ---- components used by the cases ----
+    struct Position { float x, y, z; };
+    struct Velocity { float x, y, z; };
+    struct Health   { int value; };
+    struct Handle   { uint32_t value; }; // stands in for a run-time handle (Renderable)
+    struct TagA     { int value; };
+    struct TagB     { int value; };
+    struct TagC     { int value; };
+
+} // namespace
+
+// named, so snapshots can find them again
+LGT_REGISTER_COMPONENT(lgt, Position);
+LGT_REGISTER_COMPONENT(lgt, Velocity);
+LGT_REGISTER_COMPONENT(lgt, Health);
+LGT_REGISTER_TRANSIENT_COMPONENT(lgt, Handle);
+
+using namespace lgt;
+
+// ==================== Cases ====================
+
+static void benchCreateDestroy()
+{
+    for (size_t count : { size_t(1000), size_t(100000) }) {
+        Scope<Roster> roster;
+        bench("create_destroy_churn/" + n(count), 5,
+            [&] { roster = std::make_unique<Roster>(); },
+            [&](size_t& ops) {
+                std::vector<EntityHandle> handles;
+                handles.reserve(count);
+                for (int round = 0; round < 4; round++) {
+                    for (size_t i = 0; i < count; i++) {
+                        Entity e = roster->createEntity();
+                        e.addComponent<Position>(1.0f, 2.0f, 3.0f);
+                        handles.push_back(e.getHandle());
+                    }
+                    for (const EntityHandle handle : handles)
+                        roster->destroyEntity(handle);
+                    handles.clear();
+                }
+                ops = count * 4 * 2;
+            },
+            [&] { roster.reset(); });
+    }
+}
+
+static void benchBulkSpawn()
+{
+    const size_t count = g_Options.quick ? 10000 : 100000;
+    Scope<Roster> roster;
+    bench("spawn_per_entity/" + n(count), 3,
+        [&] { roster = std::make_unique<Roster>(); },
+        [&](size_t& ops) {
+            for (size_t i = 0; i < count; i++) {
+                Entity e = roster->createEntity();
+                e.addComponent<Position>(0.0f, 0.0f, 0.0f);
+                e.addComponent<Velocity>(1.0f, 0.0f, 0.0f);
+            }
+            ops = count;
+        },
+        [&] { roster.reset(); });
+
+    bench("spawn_bulk/" + n(count), 3,
+        [&] { roster = std::make_unique<Roster>(); },
+        [&](size_t& ops) {
+            roster->createEntities(count, Position{ 0.0f, 0.0f, 0.0f }, Velocity{ 1.0f, 0.0f, 0.0f });
+            ops = count;
+        },
+        [&] { roster.reset(); });
+
+    std::vector<EntityHandle> handles;
+    bench("destroy_bulk/" + n(count), 3,
+        [&] {
+            roster = std::make_unique<Roster>();
+            handles = roster->createEntities(count, Position{}, Velocity{});
+        },
+        [&](size_t& ops) {
+            roster->destroyEntities(handles);
+            ops = count;
+        },
+        [&] { roster.reset(); });
+
+    // level unload : most entities gone, then chunks and empty archetypes handed back
+    bench("compact_after_destroy/" + n(count), 3,
+        [&] {
+            roster = std::make_unique<Roster>();
+            handles = roster->createEntities(count, Position{}, Velocity{});
+            handles.resize(count - count / 10);
+            roster->destroyEntities(handles);
+            roster->destroyEntities(roster->createEntities(count / 2, Position{}, Health{}));
+        },
+        [&](size_t& ops) {
+            roster->compact();
+            ops = count;
+        },
+        [&] { roster.reset(); });
+
+    // same spawn/destroy with an add and a remove observer on Position, e.g. a spatial index
+    size_t observed = 0;
+    auto observe = [&] {
+        roster = std::make_unique<Roster>();
+        roster->onAdd<Position>([&](std::span<const EntityHandle> entities, std::span<Position>) { observed += entities.size(); });
+        roster->onRemove<Position>([&](std::span<const EntityHandle> entities, std::span<Position* const>) { observed += entities.size(); });
+    };
+    bench("spawn_bulk_observed/" + n(count), 3,
+        observe,
+        [&](size_t& ops) {
+            roster->createEntities(count, Position{ 0.0f, 0.0f, 0.0f }, Velocity{ 1.0f, 0.0f, 0.0f });
+            ops = count;
+        },
+        [&] { roster.reset(); });
+
+    bench("destroy_bulk_observed/" + n(count), 3,
+        [&] {
+            observe();
+            handles = roster->createEntities(count, Position{}, Velocity{});
+        },
+        [&](size_t& ops) {
+            roster->destroyEntities(handles);
+            ops = count;
+        },
+        [&] { roster.reset(); });
+}
+
+static void benchMigrations()
+{
+    const size_t count = g_Options.quick ? 10000 : 100000;
+    Scope<Roster> roster;
+    std::vector<EntityHandle> handles;
+
+    // every entity walks A -> AB -> ABC -> AC -> A, hopping across several archetypes
+    bench("add_remove_migration/" + n(count), 3,
+        [&] {
+            roster = std::make_unique<Roster>();
+            handles = roster->createEntities(count, TagA{ 1 });
+        },
+        [&](size_t& ops) {
+            for (const EntityHandle handle : handles) {
+                Entity e(handle, roster.get(), "");
+                e.addComponent<TagB>(2);
+                e.addComponent<TagC>(3);
+                e.removeComponent<TagB>();
+                e.removeComponent<TagC>();
+            }
+            ops = count * 4;
+        },
+        [&] { roster.reset(); });
+
+    CommandBuffer commands;
+    bench("command_buffer_flush/" + n(count), 3,
+        [&] {
+            roster = std::make_unique<Roster>();
+            handles = roster->createEntities(count, TagA{ 1 });
+            for (size_t i = 0; i < handles.size(); i++) {
+                commands.addComponent(handles[i], TagB{ 2 });
+                if (i % 2) commands.addComponent(handles[i], TagC{ 3 });
+            }
+        },
+        [&](size_t& ops) {
+            ops = commands.size();
+            commands.flush(*roster);
+        },
+        [&] { roster.reset(); });
+}
+
+static void benchRandomAccess()
+{
+    const size_t count = g_Options.quick ? 10000 : 100000;
+    const size_t lookups = 1000000;
+    if (!selected("random_get_component/" + n(count)))
+        return;
+
+    Roster roster;
+    std::vector<EntityHandle> handles = roster.createEntities(count, Position{}, Health{ 10 });
+    // a second archetype so lookups do not all land in the same one
+    for (size_t i = 0; i < handles.size(); i += 3)
+        Entity(handles[i], &roster, "").addComponent<Velocity>();
+
+    std::vector<EntityHandle> order(lookups);
+    std::mt19937 rng(1234);
+    for (auto& handle : order)
+        handle = handles[rng() % handles.size()];
+
+    long long sink = 0;
+    bench("random_get_component/" + n(count), 5, {},
+        [&](size_t& ops) {
+            for (const EntityHandle handle : order)
+                sink += Entity(handle, &roster, "").getComponent<Health>().value;
+            ops = order.size();
+        });
+    if (sink == 42) std::fprintf(stderr, " ");
+}
+
+static void benchIteration()
+{
+    std::vector<size_t> sizes = { 1000, 100000, 1000000, 5000000 };
+    if (g_Options.quick) sizes = { 1000, 100000 };
+
+    for (const size_t count : sizes) {
+        if (!selected("iterate_each/" + n(count)) && !selected("iterate_parallel_for/" + n(count)))
+            continue;
+
+        Roster roster;
+        roster.createEntities(count, Position{ 0.0f, 0.0f, 0.0f }, Velocity{ 1.0f, 2.0f, 3.0f });
+        auto view = roster.view<Position, const Velocity>();
+
+        bench("iterate_each/" + n(count), 5, {},
+            [&](size_t& ops) {
+                view.each([](Position& p, const Velocity& v) {
+                    p.x += v.x; p.y += v.y; p.z += v.z;
+                });
+                ops = count;
+            });
+
+        JobSystem& jobs = JobSystem::get();
+        bench("iterate_parallel_for/" + n(count), 5, {},
+            [&](size_t& ops) {
+                for (Archetype* archetype : view.getArchetypes()) {
+                    jobs.parallelFor(0, archetype->getChunkCount(), 4, [&](size_t begin, size_t end) {
+                        auto integrate = [](Position& p, const Velocity& v) {
+                            p.x += v.x; p.y += v.y; p.z += v.z;
+                        };
+                        for (size_t chunk = begin; chunk < end; chunk++)
+                            view.eachInChunk(*archetype, chunk, integrate);
+                    });
+                }
+                ops = count;
+            });
+    }
+}
+
+// EntityLocations, the paged entity -> (archetype, row) table, against an unordered_map
+// index like the one it replaced.
+static void benchEntityLocations()
+{
+    std::vector<size_t> sizes = { 1000, 50000, 1000000 };
+    if (g_Options.quick) sizes = { 1000, 50000 };
+
+    // only compared against null, never dereferenced
+    Archetype* const archetype = reinterpret_cast<Archetype*>(alignof(std::max_align_t));
+
+    for (const size_t count : sizes) {
+        if (!selected("entity_locations_set_find_erase/" + n(count)) && !selected("unordered_map_set_find_erase/" + n(count)))
+            continue;
+
+        std::vector<EntityHandle> handles(count);
+        for (size_t i = 0; i < count; i++)
+            handles[i] = makeEntityHandle(static_cast<uint32_t>(i), 0);
+        std::vector<EntityHandle> order = handles;
+        std::shuffle(order.begin(), order.end(), std::mt19937(99));
+
+        size_t sink = 0;
+        EntityLocations locations;
+        bench("entity_locations_set_find_erase/" + n(count), 5,
+            [&] { locations = EntityLocations(); },
+            [&](size_t& ops) {
+                for (size_t i = 0; i < handles.size(); i++) locations.set(handles[i], archetype, i);
+                for (const EntityHandle handle : order) sink += locations.find(handle)->row;
+                for (const EntityHandle handle : order) locations.erase(handle);
+                ops = count * 3;
+            });
+
+        std::unordered_map<EntityHandle, EntityLocation> map;
+        bench("unordered_map_set_find_erase/" + n(count), 5,
+            [&] { map = {}; },
+            [&](size_t& ops) {
+                for (size_t i = 0; i < handles.size(); i++) map[handles[i]] = { archetype, static_cast<uint32_t>(i), 0 };
+                for (const EntityHandle handle : order) sink += map.find(handle)->second.row;
+                for (const EntityHandle handle : order) map.erase(handle);
+                ops = count * 3;
+            });
+        if (sink == 42) std::fprintf(stderr, " ");
+    }
+}
+
+// Same fixed workload on job systems of growing size.
+static void benchJobScaling()
+{
+    const size_t items = g_Options.quick ? (1u << 20) : (1u << 24);
+    std::vector<float> data(items, 1.0f);
+
+    const unsigned maxWorkers = std::max(1u, std::thread::hardware_concurrency()) - 1;
+    std::vector<unsigned> workerCounts = { 0 };
+    for (unsigned w = 1; w <= maxWorkers; w *= 2)
+        workerCounts.push_back(w);
+    if (workerCounts.back() != maxWorkers)
+        workerCounts.push_back(maxWorkers);
+
+    for (const unsigned workers : workerCounts) {
+        const std::string name = "job_parallel_for/threads_" + std::to_string(workers + 1);
+        if (!selected(name))
+            continue;
+
+        JobSystem jobs(workers);
+        bench(name, 5, {},
+            [&](size_t& ops) {
+                jobs.parallelFor(0, items, 16384, [&](size_t begin, size_t end) {
+                    for (size_t i = begin; i < end; i++)
+                        data[i] = data[i] * 0.5f + 1.0f;
+                });
+                ops = items;
+            });
+    }
+}
+
+// Cost of standing up an empty Roster plus its first entities.
+// Reference, same case built against older trees (g++ -O2, best of 10):
+//   eager Roster (50,000 queued handles + 50,000 UUIDs)   ~43 ms
+//   eager slot array, before paged slots                   ~31 us
+//   paged slots                                            ~2.7 us
+static void benchStartup()
+{
+    bench("startup_roster_first_entity", 10, {},
+        [&](size_t& ops) {
+            Roster roster;
+            Entity e = roster.createEntity();
+            e.addComponent<Position>();
+            ops = 1;
+        });
+}
+
+// Several million entities through spawn, partial destroy and respawn.
+static void benchStress()
+{
+    const size_t count = g_Options.quick ? 500000 : 4000000;
+    bench("stress_spawn_destroy_respawn/" + n(count), 1, {},
+        [&](size_t& ops) {
+            Roster roster;
+            std::vector<EntityHandle> handles = roster.createEntities(count, Position{}, Velocity{}, Health{ 1 });
+
+            std::vector<EntityHandle> half;
+            half.reserve(count / 2);
+            for (size_t i = 0; i < handles.size(); i += 2)
+                half.push_back(handles[i]);
+            roster.destroyEntities(half);
+
+            roster.createEntities(count / 2, Position{}, Health{ 2 });
+            roster.view<Position>().each([](Position& p) { p.x += 1.0f; });
+            ops = count * 2;
+        });
+}
+
+// Transform propagation over 100k nodes : wide (100 roots x 999 children) and deep
+// (100 chains of 1000), everything dirty, one moved root, and a full rebuild.
+static void benchHierarchy()
+{
+    const size_t count = g_Options.quick ? 10000 : 100000;
+    const size_t roots = 100;
+    const size_t perRoot = count / roots;
+
+    Mat4 offset;
+    offset.m[12] = 1.0f;
+
+    auto build = [&](TransformHierarchy& hierarchy, bool deep) {
+        for (size_t r = 0; r < roots; r++) {
+            const uint32_t first = static_cast<uint32_t>(r * perRoot);
+            hierarchy.add(makeEntityHandle(first, 0), NullEntity, offset);
+            for (uint32_t i = 1; i < perRoot; i++) {
+                const EntityHandle parent = makeEntityHandle(deep ? first + i - 1 : first, 0);
+                hierarchy.add(makeEntityHandle(first + i, 0), parent, offset);
+            }
+        }
+        hierarchy.update();
+    };
+    auto touchRoots = [&](TransformHierarchy& hierarchy, size_t rootCount) {
+        for (size_t r = 0; r < rootCount; r++)
+            hierarchy.setLocal(makeEntityHandle(static_cast<uint32_t>(r * perRoot), 0), offset);
+    };
+
+    for (const bool deep : { false, true }) {
+        const std::string shape = deep ? "deep" : "wide";
+        if (!selected("hierarchy_update_all_" + shape) && !selected("hierarchy_move_one_root_" + shape))
+            continue;
+
+        TransformHierarchy hierarchy;
+        build(hierarchy, deep);
+
+        bench("hierarchy_update_all_" + shape + "/" + n(count), 5,
+            [&] { touchRoots(hierarchy, roots); },
+            [&](size_t& ops) { ops = hierarchy.update(); });
+
+        // ops = 1 : the time of a whole update() in which one subtree moved
+        bench("hierarchy_move_one_root_" + shape + "/" + n(count), 5,
+            [&] { touchRoots(hierarchy, 1); },
+            [&](size_t& ops) { hierarchy.update(); ops = 1; });
+    }
+
+    Scope<TransformHierarchy> hierarchy;
+    bench("hierarchy_build_wide/" + n(count), 3,
+        [&] { hierarchy = std::make_unique<TransformHierarchy>(); },
+        [&](size_t& ops) { build(*hierarchy, false); ops = count; },
+        [&] { hierarchy.reset(); });
+}
+
+// Snapshot of a 100k-entity roster, compared with spawn_per_entity for a rebuild.
+static void benchSnapshot()
+{
+    const size_t count = g_Options.quick ? 10000 : 100000;
+    if (!selected("snapshot_save/" + n(count)) && !selected("snapshot_load/" + n(count)))
+        return;
+
+    const std::string path = "ecs_bench_snapshot.bin";
+    {
+        Roster roster;
+        roster.createEntities(count, Position{ 1.0f, 2.0f, 3.0f }, Velocity{}, Health{ 100 });
+        bench("snapshot_save/" + n(count), 3, {},
+            [&](size_t& ops) {
+                Snapshot::save(roster, path);
+                ops = count;
+            });
+    }
+
+    Scope<Roster> roster;
+    bench("snapshot_load/" + n(count), 5,
+        [&] { roster = std::make_unique<Roster>(); },
+        [&](size_t& ops) {
+            check(Snapshot::load(*roster, path), "snapshot_load: load() failed");
+            ops = count;
+        },
+        [&] { roster.reset(); });
+    std::remove(path.c_str());
+}
+
+// Not timed : the Scheduler's dependency graph, that conflicting systems run in
+// registration order, that parallelEach() visits every entity once, and that systems
+// building their first views at the same time on different workers get the right ones.
+static void checkScheduler()
+{
+    if (!selected("scheduler"))
+        return;
+
+    const size_t moving = 50000;
+    const size_t living = 1000;
+    JobSystem jobs(3);
+    Roster roster;
+    roster.createEntities(moving, Position{}, Velocity{ 1.0f, 0.0f, 0.0f });
+    roster.createEntities(living, Health{ 1 });
+    Scheduler scheduler(roster, jobs);
+
+    Signature withHealth, withVelocity;
+    withHealth.set(getComponentId<Health>());
+    withVelocity.set(getComponentId<Velocity>());
+
+    // 0-5 : read-only probes, free to run together, each with a query not cached yet
+    std::atomic<size_t> probeFailures{ 0 };
+    std::atomic<unsigned> started{ 0 };
+    auto probe = [&](const std::string& name, auto makeView, size_t expected) {
+        scheduler.addSystem(name).reads<Position, Velocity, Health>().run([&probeFailures, &started, makeView, expected](SystemContext& ctx) {
+            // hold each probe back a little until the other workers have one too, so the
+            // first lookups really overlap
+            started++;
+            const auto deadline = Clock::now() + std::chrono::milliseconds(20);
+            while (started < 3 && Clock::now() < deadline)
+                std::this_thread::yield();
+            if (makeView(ctx.roster).size() != expected)
+                probeFailures++;
+        });
+    };
+    probe("probe_position", [](Roster& r) { return r.view<const Position>(); }, moving);
+    probe("probe_velocity", [](Roster& r) { return r.view<const Velocity>(); }, moving);
+    probe("probe_health", [](Roster& r) { return r.view<const Health>(); }, living);
+    probe("probe_both", [](Roster& r) { return r.view<const Position, const Velocity>(); }, moving);
+    probe("probe_position_no_health", [withHealth](Roster& r) { return r.view<const Position>(withHealth); }, moving);
+    probe("probe_health_no_velocity", [withVelocity](Roster& r) { return r.view<const Health>(withVelocity); }, living);
+
+    // 6 : writes Position, reads Velocity, over the job system
+    scheduler.addSystem("move").each<Position, const Velocity>([](Position& p, const Velocity& v) { p.x += v.x; });
+    // 7 : only conflicts with the probes
+    scheduler.addSystem("heal").writes<Health>().run([](SystemContext& ctx) {
+        ctx.roster.view<Health>().each([](Health& h) { h.value++; });
+    });
+    // 8 : has to wait for move, which reads the velocity it clears
+    scheduler.addSystem("stop").writes<Velocity>().run([](SystemContext& ctx) {
+        ctx.roster.view<Velocity>().each([](Velocity& v) { v.x = 0.0f; });
+    });
+    // 9 : has to see every position moved
+    std::atomic<size_t> moved{ 0 };
+    scheduler.addSystem("observe").reads<Position>().run([&moved](SystemContext& ctx) {
+        size_t count = 0;
+        ctx.roster.view<const Position>().each([&count](const Position& p) { count += p.x == 1.0f ? 1 : 0; });
+        moved = count;
+    });
+
+    const std::vector<std::vector<size_t>> expected = {
+        {}, {}, {}, {}, {}, {},
+        { 0, 1, 2, 3, 4, 5 },
+        { 0, 1, 2, 3, 4, 5 },
+        { 0, 1, 2, 3, 4, 5, 6 },
+        { 6 },
+    };
+    check(scheduler.getDependencies() == expected, "scheduler: dependency graph");
+
+    for (int frame = 1; frame <= 2; frame++) {
+        moved = 0;
+        scheduler.run(0.016f);
+        const std::string at = "scheduler (frame " + std::to_string(frame) + "): ";
+        check(probeFailures == 0, at + "a probe view had the wrong entities");
+        check(moved == moving, at + "observe ran before move, or move skipped entities");
+
+        size_t once = 0, stopped = 0, healed = 0;
+        roster.view<const Position, const Velocity>().each([&](const Position& p, const Velocity& v) {
+            once += p.x == 1.0f ? 1 : 0; // a second visit, or stop before move, changes it
+            stopped += v.x == 0.0f ? 1 : 0;
+        });
+        roster.view<const Health>().each([&](const Health& h) { healed += h.value == 1 + frame ? 1 : 0; });
+        check(once == moving, at + "parallelEach did not visit every entity exactly once");
+        check(stopped == moving, at + "stop did not run");
+        check(healed == living, at + "heal did not run exactly once");
+    }
+}
+
+// Not timed : a stale handle (its entity destroyed, the index reused) can't destroy or
+// change the entity that now owns the index, in release builds too.
+static void checkStaleHandles()
+{
+    if (!selected("stale_handles"))
+        return;
+
+    Roster roster;
+    const EntityHandle stale = roster.createEntity().getHandle();
+    roster.destroyEntity(stale);
+    roster.destroyEntity(stale);
+    const EntityHandle first = roster.createEntity().getHandle();
+    const EntityHandle second = roster.createEntity().getHandle();
+    check(entityIndex(first) != entityIndex(second) && roster.isAlive(first) && roster.isAlive(second),
+        "stale_handles: destroying twice freed the index twice");
+
+    roster.destroyEntity(first);
+    Entity live = roster.createEntity();
+    live.addComponent<Position>(42.0f, 0.0f, 0.0f);
+    Entity dead(first, &roster, "");
+    dead.addComponent<Velocity>();
+    check(!dead.removeComponent<Position>(), "stale_handles: removeComponent() through a stale handle");
+    check(live.hasComponent<Position>() && live.getComponent<Position>().x == 42.0f && !live.hasComponent<Velocity>(),
+        "stale_handles: the live entity was changed through a stale handle");
+
+    size_t velocities = 0;
+    roster.view<Velocity>().each([&](Velocity&) { velocities++; });
+    check(velocities == 0, "stale_handles: a stale handle owns a row");
+}
+
+// Not timed : a mixed-archetype roster survives save + load with its values and UUIDs
+// (transient components left out), and truncated or corrupt files are rejected without
+// touching the roster.
+static void checkSnapshot()
+{
+    if (!selected("snapshot_roundtrip"))
+        return;
+
+    const std::string path = "ecs_bench_roundtrip.bin";
+    struct Expected {
+        Position position;
+        bool     hasVelocity;
+        float    velocity;
+        bool     hasHealth;
+        int      health;
+    };
+    std::unordered_map<UUID, Expected> expected;
+    {
+        Roster roster;
+        std::vector<EntityHandle> moving = roster.createEntities(3000, Position{}, Velocity{});
+        std::vector<EntityHandle> living = roster.createEntities(500, Position{}, Health{});
+        std::vector<EntityHandle> both = roster.createEntities(70, Position{}, Velocity{}, Health{}, Handle{ 7 });
+        for (int i = 0; i < 7; i++)
+            roster.createEntity(); // no components, not saved
+        roster.destroyEntities(std::span<const EntityHandle>(living).first(100));
+
+        float value = 0.0f;
+        for (const auto* group : { &moving, &living, &both }) {
+            for (const EntityHandle entity : *group) {
+                if (!roster.isAlive(entity)) continue;
+                Entity e(entity, &roster, "");
+                Expected& values = expected[e.getUUID()];
+                values = { Position{ value, value + 1.0f, value + 2.0f }, e.hasComponent<Velocity>(), -value, e.hasComponent<Health>(), static_cast<int>(value) };
+                e.getComponent<Position>() = values.position;
+                if (values.hasVelocity) e.getComponent<Velocity>() = Velocity{ values.velocity, 0.0f, 0.0f };
+                if (values.hasHealth) e.getComponent<Health>() = Health{ values.health };
+                value += 1.0f;
+            }
+        }
+        check(Snapshot::save(roster, path), "snapshot_roundtrip: save() failed");
+    }
+
+    std::vector<char> file;
+    {
+        std::ifstream in(path, std::ios::binary);
+        file.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    Roster loaded;
+    std::vector<EntityHandle> created;
+    check(Snapshot::load(loaded, path, &created), "snapshot_roundtrip: load() failed");
+    check(created.size() == expected.size(), "snapshot_roundtrip: entity count");
+    size_t matched = 0;
+    for (const EntityHandle entity : created) {
+        Entity e(entity, &loaded, "");
+        auto it = expected.find(e.getUUID());
+        if (!check(it != expected.end(), "snapshot_roundtrip: unknown UUID")) continue;
+        const Expected& values = it->second;
+        const Position& position = e.getComponent<Position>();
+        bool same = position.x == values.position.x && position.y == values.position.y && position.z == values.position.z
+            && e.hasComponent<Velocity>() == values.hasVelocity && e.hasComponent<Health>() == values.hasHealth
+            && !e.hasComponent<Handle>();
+        if (same && values.hasVelocity) same = e.getComponent<Velocity>().x == values.velocity;
+        if (same && values.hasHealth) same = e.getComponent<Health>().value == values.health;
+        matched += same ? 1 : 0;
+    }
+    check(matched == expected.size(), "snapshot_roundtrip: component values");
+
+    auto rejects = [&](const std::vector<char>& bytes, const std::string& what) {
+        {
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        }
+        Roster roster;
+        std::vector<EntityHandle> handles;
+        const bool rejected = !Snapshot::load(roster, path, &handles) && handles.empty();
+        size_t entities = 0;
+        roster.view<Position>().each([&](Position&) { entities++; });
+        check(rejected && entities == 0, "snapshot_roundtrip: " + what + " was not rejected");
+    };
+
+    for (const size_t length : { size_t(0), size_t(16), file.size() / 3, file.size() / 2, file.size() - 64, file.size() - 1 })
+        rejects(std::vector<char>(file.begin(), file.begin() + length), "file truncated to " + std::to_string(length) + " bytes");
+
+    // header : magic, version, componentCount, archetypeCount (uint32 each), entityCount
+    auto patched = [&](size_t offset, uint64_t value, size_t size) {
+        std::vector<char> bytes = file;
+        std::memcpy(bytes.data() + offset, &value, size);
+        return bytes;
+    };
+    rejects(patched(0, 0, 1), "bad magic");
+    rejects(patched(8, ~uint64_t(0), 4), "huge component count");
+    rejects(patched(12, ~uint64_t(0), 4), "huge archetype count");
+
+    // the first archetype record follows the component records (16 bytes + name, padded to 8)
+    size_t offset = 24;
+    uint32_t componentCount = 0;
+    std::memcpy(&componentCount, file.data() + 8, 4);
+    for (uint32_t i = 0; i < componentCount; i++) {
+        uint32_t nameLength = 0;
+        std::memcpy(&nameLength, file.data() + offset + 8, 4);
+        offset = (offset + 16 + nameLength + 7) & ~size_t(7);
+    }
+    // 2^62 rows : rows * 16 bytes of UUIDs wraps to 0 without checked sizes
+    rejects(patched(offset, uint64_t(1) << 62, 8), "row count of 2^62");
+    rejects(patched(offset, uint64_t(1) << 60, 8), "row count of 2^60");
+    rejects(patched(offset, expected.size() + 1, 8), "row count past the blobs");
+    rejects(patched(offset + 8, 1u << 30, 4), "huge column count");
+
+    std::remove(path.c_str());
+}
+
+// ==================== main ====================
+
+int main(int argc, char** argv)
+{
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        auto next = [&]() -> std::string { return i + 1 < argc ? argv[++i] : std::string(); };
+        if (arg == "--quick")          g_Options.quick = true;
+        else if (arg == "--filter")    g_Options.filter = next();
+        else if (arg == "--out")       g_Options.out = next();
+        else if (arg == "--baseline")  g_Options.baseline = next();
+        else if (arg == "--threshold") g_Options.threshold = std::atof(next().c_str());
+        else {
+            std::fprintf(stderr, "usage: EcsBench [--quick] [--filter <substr>] [--out <file>] [--baseline <file>] [--threshold <pct>]\n");
+            return 2;
+        }
+    }
+
+    benchStartup();
+    benchEntityLocations();
+    benchCreateDestroy();
+    benchBulkSpawn();
+    benchMigrations();
+    benchRandomAccess();
+    benchIteration();
+    benchJobScaling();
+    benchHierarchy();
+    benchSnapshot();
+    checkSnapshot();
+    checkStaleHandles();
+    checkScheduler();
+    benchStress();
+
+    std::ostringstream json;
+    json << "{\"benchmarks\":[\n";
+    for (size_t i = 0; i < g_Results.size(); i++)
+        json << toJson(g_Results[i]) << (i + 1 < g_Results.size() ? ",\n" : "\n");
+    json << "]}\n";
+
+    if (g_Options.out.empty()) {
+        std::fputs(json.str().c_str(), stdout);
+    }
+    else {
+        std::ofstream(g_Options.out) << json.str();
+    }
+
+    int status = g_Failures > 0 ? 1 : 0;
+    if (g_Failures > 0)
+        std::fprintf(stderr, "\n%zu check(s) failed\n", g_Failures);
+    if (!g_Options.baseline.empty()) {
+        const auto baseline = loadBaseline(g_Options.baseline);
+        std::fprintf(stderr, "\n%-44s %12s %12s %9s\n", "case", "baseline", "current", "change");
+        for (const Result& result : g_Results) {
+            auto it = baseline.find(result.name);
+            if (it == baseline.end()) continue;
+            const double change = (result.nsPerOp - it->second) / it->second * 100.0;
+            const bool regressed = change > g_Options.threshold;
+            std::fprintf(stderr, "%-44s %12.2f %12.2f %+8.1f%%%s\n",
+                result.name.c_str(), it->second, result.nsPerOp, change, regressed ? "  REGRESSION" : "");
+            if (regressed) status = 1;
+        }
+    }
+    return status;
+}
@@ -0,0 +1,218 @@
+// Headless check of GpuCulling on a hidden GL 4.5 core window, fine on a software
+// rasterizer (Mesa's llvmpipe).
+//
+//   GpuCullingTest
+//
+// Run from the repository root so res/shaders resolves. Uploads instances with known
+// visibility (inside the frustum, outside it, behind an occluder, in front of it), builds
+// the Hi-Z pyramid from a hand-written depth buffer, culls with and without occlusion and
+// checks every command's instanceCount, the culled instances and readVisibleCount().
+// Returns 1 when a check fails, 0 when all pass or when no GL 4.5 context can be created
+// (the test is then skipped).
+
+#include "Renderer/renderer.h"
+#include "Renderer/GpuCulling.h"
+#include "Renderer/GeometryBuffer.h"
+#include "Renderer/RenderQueue.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+    constexpr int WIDTH = 64;
+    constexpr int HEIGHT = 64;
+
+    // RenderQueue::InstanceData
+    struct Instance {
+        glm::mat4 model;
+        glm::mat4 normal;
+    };
+
+    size_t g_Failures = 0;
+
+    bool check(bool condition, const std::string& what) {
+        if (!condition) {
+            std::fprintf(stderr, "CHECK FAILED: %s\n", what.c_str());
+            g_Failures++;
+        }
+        return condition;
+    }
+
+    Instance at(const glm::vec3& position) {
+        return { glm::translate(glm::mat4(1.0f), position), glm::mat4(1.0f) };
+    }
+
+    // The scene, two meshes (both a sphere of radius 0.5 at the origin) seen from the
+    // origin down -Z. The depth buffer holds an occluder at z = -10 over the left half of
+    // the screen and nothing over the right half.
+    struct Scene {
+        std::vector<Instance> instances;
+        std::vector<GLuint>   instanceCommands;
+        std::vector<GLuint>   expectedVisible;  // per command, without occlusion
+        std::vector<GLuint>   expectedUnoccluded;
+    };
+
+    Scene makeScene() {
+        Scene scene;
+        auto add = [&](GLuint command, const glm::vec3& position) {
+            scene.instances.push_back(at(position));
+            scene.instanceCommands.push_back(command);
+        };
+        // mesh 0 : one visible, one behind the camera, one far off to the right
+        add(0, { 0.0f, 0.0f, -5.0f });
+        add(0, { 0.0f, 0.0f, 10.0f });
+        add(0, { 50.0f, 0.0f, -5.0f });
+        // mesh 1 : behind the occluder, on the empty right half, in front of the occluder
+        add(1, { -3.0f, 0.0f, -20.0f });
+        add(1, { 3.0f, 0.0f, -20.0f });
+        add(1, { -3.0f, 0.0f, -4.0f });
+
+        scene.expectedVisible = { 1, 3 };
+        scene.expectedUnoccluded = { 1, 2 };
+        return scene;
+    }
+
+    std::vector<DrawElementsIndirectCommand> makeCommands(const Scene& scene) {
+        std::vector<DrawElementsIndirectCommand> commands(scene.expectedVisible.size(), DrawElementsIndirectCommand{ 36, 0, 0, 0, 0 });
+        // each command's range starts after the instances of the ones before it
+        GLuint base = 0;
+        for (size_t c = 0; c < commands.size(); c++) {
+            commands[c].baseInstance = base;
+            for (GLuint command : scene.instanceCommands)
+                base += command == c ? 1 : 0;
+        }
+        return commands;
+    }
+
+    // Left half at the depth of z = -10, right half at the far plane.
+    GLuint makeDepthTexture(const glm::mat4& projection) {
+        const glm::vec4 clip = projection * glm::vec4(0.0f, 0.0f, -10.0f, 1.0f);
+        const float occluder = clip.z / clip.w * 0.5f + 0.5f;
+
+        std::vector<float> depth(WIDTH * HEIGHT);
+        for (int y = 0; y < HEIGHT; y++) {
+            for (int x = 0; x < WIDTH; x++)
+                depth[y * WIDTH + x] = x < WIDTH / 2 ? occluder : 1.0f;
+        }
+
+        GLuint texture = 0;
+        glCreateTextures(GL_TEXTURE_2D, 1, &texture);
+        glTextureStorage2D(texture, 1, GL_DEPTH_COMPONENT32F, WIDTH, HEIGHT);
+        glTextureParameteri(texture, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTextureParameteri(texture, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTextureSubImage2D(texture, 0, 0, 0, WIDTH, HEIGHT, GL_DEPTH_COMPONENT, GL_FLOAT, depth.data());
+        return texture;
+    }
+
+    // Culls the scene once and checks the commands the GPU filled in and the culled
+    // instance buffer left at RenderQueue::INSTANCE_BINDING.
+    void runCull(GpuCulling& culling, const Scene& scene, GLuint instances, const glm::mat4& viewProjection,
+                 bool occlusion, const std::vector<GLuint>& expected, const std::string& label) {
+        const std::vector<DrawElementsIndirectCommand> commands = makeCommands(scene);
+        GLuint commandBuffer = 0;
+        glCreateBuffers(1, &commandBuffer);
+        glNamedBufferData(commandBuffer, commands.size() * sizeof(DrawElementsIndirectCommand), commands.data(), GL_DYNAMIC_COPY);
+
+        const std::vector<glm::vec4> bounds(commands.size(), glm::vec4(0.0f, 0.0f, 0.0f, 0.5f));
+        culling.cull(instances, scene.instanceCommands, commandBuffer, bounds, viewProjection, occlusion);
+
+        std::vector<DrawElementsIndirectCommand> result(commands.size());
+        glGetNamedBufferSubData(commandBuffer, 0, result.size() * sizeof(DrawElementsIndirectCommand), result.data());
+
+        GLuint total = 0;
+        for (size_t c = 0; c < result.size(); c++) {
+            check(result[c].instanceCount == expected[c],
+                label + ": command " + std::to_string(c) + " instanceCount " + std::to_string(result[c].instanceCount)
+                + ", expected " + std::to_string(expected[c]));
+            check(result[c].baseInstance == commands[c].baseInstance && result[c].count == commands[c].count,
+                label + ": command " + std::to_string(c) + " changed outside instanceCount");
+            total += expected[c];
+        }
+        const GLuint visible = culling.readVisibleCount();
+        check(visible == total, label + ": readVisibleCount() " + std::to_string(visible) + ", expected " + std::to_string(total));
+
+        // the one visible mesh 0 instance is the first in its range
+        GLint culled = 0;
+        glGetIntegeri_v(GL_SHADER_STORAGE_BUFFER_BINDING, RenderQueue::INSTANCE_BINDING, &culled);
+        if (check(culled != 0 && static_cast<GLuint>(culled) != instances, label + ": culled instances not bound")
+            && result[0].instanceCount == 1) {
+            Instance first{};
+            glGetNamedBufferSubData(static_cast<GLuint>(culled), result[0].baseInstance * sizeof(Instance), sizeof(Instance), &first);
+            check(first.model == scene.instances[0].model, label + ": wrong instance written for command 0");
+        }
+
+        glDeleteBuffers(1, &commandBuffer);
+    }
+
+} // namespace
+
+int main()
+{
+    if (!glfwInit()) {
+        std::printf("SKIPPED: glfwInit failed\n");
+        return 0;
+    }
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    GLFWwindow* window = glfwCreateWindow(WIDTH, HEIGHT, "GpuCullingTest", nullptr, nullptr);
+    if (!window) {
+        std::printf("SKIPPED: no GL 4.5 core context\n");
+        glfwTerminate();
+        return 0;
+    }
+    glfwMakeContextCurrent(window);
+    glewExperimental = GL_TRUE;
+    if (glewInit() != GLEW_OK || !GLEW_VERSION_4_5) {
+        std::printf("SKIPPED: GL 4.5 entry points unavailable\n");
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 0;
+    }
+    std::printf("GL %s on %s\n", glGetString(GL_VERSION), glGetString(GL_RENDERER));
+
+    {
+        GpuCulling culling;
+        if (!check(culling.isValid(), "cull / Hi-Z shaders failed to build (run from the repository root)")) {
+            glfwDestroyWindow(window);
+            glfwTerminate();
+            return 1;
+        }
+
+        const Scene scene = makeScene();
+        GLuint instances = 0;
+        glCreateBuffers(1, &instances);
+        glNamedBufferData(instances, scene.instances.size() * sizeof(Instance), scene.instances.data(), GL_STATIC_DRAW);
+
+        const glm::mat4 projection = glm::perspective(glm::radians(90.0f), static_cast<float>(WIDTH) / HEIGHT, 0.1f, 100.0f);
+        const glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        const glm::mat4 viewProjection = projection * view;
+
+        // no pyramid yet : occlusion is ignored
+        runCull(culling, scene, instances, viewProjection, true, scene.expectedVisible, "before buildHiZ");
+
+        const GLuint depth = makeDepthTexture(projection);
+        culling.buildHiZ(depth, WIDTH, HEIGHT);
+        check(culling.hasHiZ(), "buildHiZ left no pyramid");
+
+        runCull(culling, scene, instances, viewProjection, false, scene.expectedVisible, "frustum");
+        runCull(culling, scene, instances, viewProjection, true, scene.expectedUnoccluded, "occlusion");
+
+        GLState::get().onTextureDeleted(depth);
+        glDeleteTextures(1, &depth);
+        glDeleteBuffers(1, &instances);
+    }
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+
+    if (g_Failures > 0) {
+        std::fprintf(stderr, "\n%zu check(s) failed\n", g_Failures);
+        return 1;
+    }
+    std::printf("all checks passed\n");
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,328 @@
+#include "Archetype.h"
+
+#include <algorithm>
+#include <functional>
+#include <new>
+
+namespace lgt {
+
+    static size_t alignUp(size_t value, size_t align) {
+        return (value + align - 1) & ~(align - 1);
+    }
+
+    Archetype::Archetype(const Signature& signature, const std::atomic<Tick>& worldTick, EntityLocations& locations)
+        : m_Signature(signature), m_Locations(&locations), m_WorldTick(&worldTick)
+    {
+        // lookup tables only reach the highest id in use, not MAX_COMPONENTS
+        signature.forEach([this](size_t bit) {
+            const ComponentId id = static_cast<ComponentId>(bit);
+            m_ColumnIndex.resize(id + 1, -1);
+            m_ColumnIndex[id] = static_cast<int>(m_Columns.size());
+            m_Columns.push_back({ ComponentRegistry::getInfo(id), 0 });
+        });
+        computeLayout();
+    }
+
+    Archetype::~Archetype()
+    {
+        for (size_t row = 0; row < m_Entities.size(); row++)
+            destroyRow(row);
+
+        for (std::byte* chunk : m_Chunks)
+            ::operator delete(chunk, std::align_val_t(CHUNK_ALIGN));
+    }
+
+    // Picks the largest row count whose columns (each aligned) fit in CHUNK_SIZE.
+    // A row bigger than a whole chunk gets a one-row chunk of its own size.
+    void Archetype::computeLayout()
+    {
+        size_t rowBytes = 0;
+        for (const auto& col : m_Columns)
+            rowBytes += col.info.size;
+
+        auto layout = [this](size_t capacity) {
+            size_t offset = 0;
+            for (auto& col : m_Columns) {
+                offset = alignUp(offset, col.info.align);
+                col.offset = offset;
+                offset += col.info.size * capacity;
+            }
+            return offset;
+        };
+
+        m_ChunkCapacity = rowBytes ? std::max<size_t>(CHUNK_SIZE / rowBytes, 1) : CHUNK_SIZE;
+        m_ChunkBytes = layout(m_ChunkCapacity);
+        while (m_ChunkCapacity > 1 && m_ChunkBytes > CHUNK_SIZE) {
+            m_ChunkCapacity--;
+            m_ChunkBytes = layout(m_ChunkCapacity);
+        }
+    }
+
+    const Signature& Archetype::getSignature() const {
+        return m_Signature;
+    }
+
+    int Archetype::columnIndex(ComponentId typeId) const {
+        return (typeId >= 0 && typeId < static_cast<ComponentId>(m_ColumnIndex.size())) ? m_ColumnIndex[typeId] : -1;
+    }
+
+    bool Archetype::hasComponentType(ComponentId typeId) const {
+        return columnIndex(typeId) >= 0;
+    }
+
+    bool Archetype::hasEntity(const EntityHandle& entity) const {
+        const EntityLocation* location = m_Locations->find(entity);
+        return location && location->archetype == this;
+    }
+
+    void Archetype::reserve(size_t rows)
+    {
+        const size_t chunks = (rows + m_ChunkCapacity - 1) / m_ChunkCapacity;
+        while (m_Chunks.size() < chunks)
+            m_Chunks.push_back(static_cast<std::byte*>(::operator new(std::max<size_t>(m_ChunkBytes, 1), std::align_val_t(CHUNK_ALIGN))));
+        m_ChangedTicks.resize(m_Chunks.size() * m_Columns.size(), 0);
+        m_AddedTicks.resize(m_Chunks.size() * m_Columns.size(), 0);
+        // grow geometrically : migrations reserve one row at a time
+        if (rows > m_Entities.capacity())
+            m_Entities.reserve(std::max(rows, m_Entities.capacity() * 2));
+    }
+
+    ArchetypeMemoryStats Archetype::getMemoryStats() const
+    {
+        ArchetypeMemoryStats stats;
+        stats.signature = m_Signature;
+        stats.entities = m_Entities.size();
+        stats.chunks = m_Chunks.size();
+        stats.chunkCapacity = m_ChunkCapacity;
+
+        size_t columnBytesUsed = 0;
+        for (const auto& col : m_Columns) {
+            const size_t used = col.info.size * m_Entities.size();
+            stats.components.push_back({ col.info.id, ComponentRegistry::getInfo(col.info.id).name,
+                                         col.info.size * m_ChunkCapacity * m_Chunks.size(), used });
+            columnBytesUsed += used;
+        }
+
+        stats.bytesReserved = m_Chunks.size() * m_ChunkBytes
+                            + m_Entities.capacity() * sizeof(EntityHandle)
+                            + (m_ChangedTicks.capacity() + m_AddedTicks.capacity()) * sizeof(Tick);
+        stats.bytesUsed = columnBytesUsed
+                        + m_Entities.size() * sizeof(EntityHandle)
+                        + getChunkCount() * m_Columns.size() * 2 * sizeof(Tick);
+        return stats;
+    }
+
+    size_t Archetype::shrinkToFit()
+    {
+        const size_t before = getMemoryStats().bytesReserved;
+
+        const size_t live = getChunkCount();
+        for (size_t chunk = live; chunk < m_Chunks.size(); chunk++)
+            ::operator delete(m_Chunks[chunk], std::align_val_t(CHUNK_ALIGN));
+        m_Chunks.resize(live);
+        m_Chunks.shrink_to_fit();
+        m_ChangedTicks.resize(live * m_Columns.size());
+        m_ChangedTicks.shrink_to_fit();
+        m_AddedTicks.resize(live * m_Columns.size());
+        m_AddedTicks.shrink_to_fit();
+        m_Entities.shrink_to_fit();
+
+        return before - getMemoryStats().bytesReserved;
+    }
+
+    size_t Archetype::addEntity(const EntityHandle& entity)
+    {
+        if (hasEntity(entity))
+            return getRow(entity);
+
+        const size_t row = m_Entities.size();
+        if (row / m_ChunkCapacity >= m_Chunks.size())
+            reserve(row + 1);
+
+        m_Entities.push_back(entity);
+        m_Locations->set(entity, this, row);
+        stampRows(row, 1, nullptr);
+        return row;
+    }
+
+    size_t Archetype::addEntities(std::span<const EntityHandle> entities)
+    {
+        const size_t first = m_Entities.size();
+        reserve(first + entities.size());
+        for (const EntityHandle& entity : entities) {
+            m_Locations->set(entity, this, m_Entities.size());
+            m_Entities.push_back(entity);
+        }
+        stampRows(first, entities.size(), nullptr);
+        return first;
+    }
+
+    bool Archetype::removeEntity(EntityHandle entity)
+    {
+        if (!hasEntity(entity))
+            return false;
+
+        removeRow(getRow(entity));
+        return true;
+    }
+
+    void Archetype::removeRow(size_t row)
+    {
+        const size_t last = m_Entities.size() - 1;
+
+        destroyRow(row);
+        if (row != last) {
+            for (const auto& col : m_Columns) {
+                col.info.moveConstruct(slot(col, row), slot(col, last));
+                col.info.destroy(slot(col, last));
+            }
+            stampRows(row, 1, &m_Signature); // the hole now holds another entity's data
+            m_Entities[row] = m_Entities[last];
+            m_Locations->set(m_Entities[row], this, row);
+        }
+        m_Entities.pop_back();
+    }
+
+    size_t Archetype::migrateRows(Archetype& dst, std::span<size_t> rows)
+    {
+        const size_t dstBegin = dst.getSize();
+        dst.reserve(dstBegin + rows.size());
+        for (const size_t row : rows) {
+            m_Locations->set(m_Entities[row], &dst, dst.m_Entities.size());
+            dst.m_Entities.push_back(m_Entities[row]);
+        }
+
+        // both column lists are sorted by id, so one merge walk pairs them up
+        auto dstCol = dst.m_Columns.begin();
+        for (const auto& col : m_Columns) {
+            while (dstCol != dst.m_Columns.end() && dstCol->info.id < col.info.id)
+                ++dstCol;
+            if (dstCol == dst.m_Columns.end() || dstCol->info.id != col.info.id)
+                continue;
+
+            for (size_t i = 0; i < rows.size(); i++)
+                col.info.moveConstruct(dst.slot(*dstCol, dstBegin + i), slot(col, rows[i]));
+        }
+        dst.stampRows(dstBegin, rows.size(), &m_Signature);
+
+        removeRows(rows);
+        return dstBegin;
+    }
+
+    void Archetype::removeRows(std::span<size_t> rows)
+    {
+        // remove from the back so a pending row is never the one swapped into a hole
+        std::sort(rows.begin(), rows.end(), std::greater<size_t>());
+        for (const size_t row : rows)
+            removeRow(row);
+    }
+
+    void Archetype::stampRows(size_t first, size_t count, const Signature* previous)
+    {
+        if (count == 0) return;
+
+        const Tick tick = m_WorldTick->load(std::memory_order_relaxed);
+        const size_t lastChunk = (first + count - 1) / m_ChunkCapacity;
+        for (size_t chunk = first / m_ChunkCapacity; chunk <= lastChunk; chunk++) {
+            for (size_t col = 0; col < m_Columns.size(); col++) {
+                m_ChangedTicks[chunk * m_Columns.size() + col] = tick;
+                if (!previous || !previous->test(m_Columns[col].info.id))
+                    m_AddedTicks[chunk * m_Columns.size() + col] = tick;
+            }
+        }
+    }
+
+    Tick Archetype::getChangedTick(ComponentId typeId, size_t chunk) const {
+        const int col = columnIndex(typeId);
+        return col >= 0 ? m_ChangedTicks[chunk * m_Columns.size() + col] : 0;
+    }
+
+    Tick Archetype::getAddedTick(ComponentId typeId, size_t chunk) const {
+        const int col = columnIndex(typeId);
+        return col >= 0 ? m_AddedTicks[chunk * m_Columns.size() + col] : 0;
+    }
+
+    void Archetype::markChanged(ComponentId typeId, size_t chunk) {
+        const int col = columnIndex(typeId);
+        LGT_ASSERT_MSG(col >= 0, "[Archetype::markChanged] Component column not found.");
+        m_ChangedTicks[chunk * m_Columns.size() + col] = m_WorldTick->load(std::memory_order_relaxed);
+    }
+
+    size_t Archetype::getRow(const EntityHandle& entity) const {
+        LGT_ASSERT_MSG(hasEntity(entity), "[Archetype::getRow] Entity not in archetype.");
+        return m_Locations->find(entity)->row;
+    }
+
+    void Archetype::destroyRow(size_t row)
+    {
+        for (const auto& col : m_Columns)
+            col.info.destroy(slot(col, row));
+    }
+
+    void* Archetype::slot(const Column& column, size_t row) const
+    {
+        return m_Chunks[row / m_ChunkCapacity] + column.offset + (row % m_ChunkCapacity) * column.info.size;
+    }
+
+    void* Archetype::getComponentPtr(ComponentId typeId, size_t row) const
+    {
+        const int col = columnIndex(typeId);
+        LGT_ASSERT_MSG(col >= 0, "[Archetype::getComponentPtr] Component column not found.");
+        return slot(m_Columns[col], row);
+    }
+
+    const std::vector<EntityHandle>& Archetype::getEntities() const {
+        return m_Entities;
+    }
+
+    size_t Archetype::getSize() const {
+        return m_Entities.size();
+    }
+
+    size_t Archetype::getChunkCount() const {
+        return (m_Entities.size() + m_ChunkCapacity - 1) / m_ChunkCapacity;
+    }
+
+    size_t Archetype::getChunkCapacity() const {
+        return m_ChunkCapacity;
+    }
+
+    size_t Archetype::getChunkSize(size_t chunk) const {
+        const size_t begin = chunk * m_ChunkCapacity;
+        return std::min(m_ChunkCapacity, m_Entities.size() - begin);
+    }
+
+    const EntityHandle* Archetype::getChunkEntities(size_t chunk) const {
+        return m_Entities.data() + chunk * m_ChunkCapacity;
+    }
+
+    const std::vector<Archetype::Column>& Archetype::getColumns() const {
+        return m_Columns;
+    }
+
+    Archetype* Archetype::getAddEdge(ComponentId typeId) const {
+        return typeId < static_cast<ComponentId>(m_AddEdges.size()) ? m_AddEdges[typeId] : nullptr;
+    }
+
+    Archetype* Archetype::getRemoveEdge(ComponentId typeId) const {
+        return typeId < static_cast<ComponentId>(m_RemoveEdges.size()) ? m_RemoveEdges[typeId] : nullptr;
+    }
+
+    void Archetype::setAddEdge(ComponentId typeId, Archetype* target) {
+        if (typeId >= static_cast<ComponentId>(m_AddEdges.size()))
+            m_AddEdges.resize(typeId + 1, nullptr);
+        m_AddEdges[typeId] = target;
+    }
+
+    void Archetype::clearEdges() {
+        m_AddEdges.clear();
+        m_RemoveEdges.clear();
+    }
+
+    void Archetype::setRemoveEdge(ComponentId typeId, Archetype* target) {
+        if (typeId >= static_cast<ComponentId>(m_RemoveEdges.size()))
+            m_RemoveEdges.resize(typeId + 1, nullptr);
+        m_RemoveEdges[typeId] = target;
+    }
+
+} // namespace lgt
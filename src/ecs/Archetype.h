@@ -0,0 +1,144 @@
+#pragma once
+#include "Defines.h"
+#include "ComponentRegistry.h"
+#include "EntityLocations.h"
+#include "MemoryStats.h"
+
+#include <vector>
+#include <span>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace lgt {
+
+    // An archetype owns every entity whose signature matches exactly.
+    // Entities live in fixed-size chunks; each chunk holds one contiguous column per
+    // component type (SoA) and row N of every column belongs to the same entity,
+    // so iterating a chunk is a linear sweep over a handful of arrays.
+    // Every (chunk, column) pair also records the world tick of its last write and of
+    // the last time a component was added to it, so queries can skip untouched chunks.
+    // Rows are tracked in the owner's EntityLocations table, which every row move
+    // (append, swap-remove, migration) keeps up to date.
+    struct Archetype {
+    public:
+        static constexpr size_t CHUNK_SIZE  = 16 * 1024;
+        static constexpr size_t CHUNK_ALIGN = 64;
+
+        struct Column {
+            ComponentInfo info;
+            size_t        offset; // byte offset of the column inside a chunk
+        };
+
+        Archetype(const Signature& signature, const std::atomic<Tick>& worldTick, EntityLocations& locations);
+        ~Archetype();
+
+        Archetype(const Archetype&) = delete;
+        Archetype& operator=(const Archetype&) = delete;
+
+        const Signature& getSignature() const;
+        bool hasComponentType(ComponentId typeId) const;
+        bool hasEntity(const EntityHandle& entity) const;
+
+        // Reserves a row for the entity; its component slots are left unconstructed
+        // and must be filled with emplaceComponent() / moved in by the caller.
+        size_t addEntity(const EntityHandle& entity);
+        // Appends rows for all entities at once (chunks reserved up front), same contract
+        // as addEntity(). Returns the first row of the block.
+        size_t addEntities(std::span<const EntityHandle> entities);
+        // Destroys every component of the entity and swap-removes its row.
+        // The entity's own location record is left for the caller to erase or overwrite.
+        bool removeEntity(EntityHandle entity);
+        // Moves the given rows into dst (appended in the same order) in one pass per
+        // column: shared columns are move-constructed, the rest are destroyed.
+        // Columns that only dst has are left unconstructed for the caller to fill.
+        // Returns the first dst row of the moved block. rows is left sorted back to front.
+        size_t migrateRows(Archetype& dst, std::span<size_t> rows);
+        // Destroys the given rows and swap-removes them, back to front (sorts rows in place).
+        void   removeRows(std::span<size_t> rows);
+        void   reserve(size_t rows);
+        size_t getRow(const EntityHandle& entity) const;
+        const std::vector<EntityHandle>& getEntities() const;
+        size_t getSize() const;
+
+        // ---- chunk access ----
+        size_t getChunkCount() const;
+        size_t getChunkCapacity() const;
+        size_t getChunkSize(size_t chunk) const; // live rows in that chunk
+        const EntityHandle* getChunkEntities(size_t chunk) const;
+        const std::vector<Column>& getColumns() const;
+
+        // ---- change ticks (per chunk, per column) ----
+        Tick getChangedTick(ComponentId typeId, size_t chunk) const;
+        Tick getAddedTick(ComponentId typeId, size_t chunk) const;
+        // Stamps the column of that chunk with the current world tick.
+        void markChanged(ComponentId typeId, size_t chunk);
+        void markRowChanged(ComponentId typeId, size_t row) { markChanged(typeId, row / m_ChunkCapacity); }
+
+        // ---- memory ----
+        ArchetypeMemoryStats getMemoryStats() const;
+        // Frees the chunks past the last row and trims the row bookkeeping to the live rows.
+        // Rows are always packed (swap-remove), so this is all a defragmentation needs.
+        // Returns the bytes released.
+        size_t shrinkToFit();
+
+        // ---- transition graph : cached neighbour archetype per added/removed component ----
+        Archetype* getAddEdge(ComponentId typeId) const;
+        Archetype* getRemoveEdge(ComponentId typeId) const;
+        void setAddEdge(ComponentId typeId, Archetype* target);
+        void setRemoveEdge(ComponentId typeId, Archetype* target);
+        // Drops every cached edge, they are looked up again on the next transition.
+        void clearEdges();
+
+        template<typename T>
+        T* getColumn(size_t chunk) const {
+            const int col = columnIndex(getComponentId<T>());
+            LGT_ASSERT_MSG(col >= 0, "[Archetype::getColumn] Component column not found.");
+            return reinterpret_cast<T*>(m_Chunks[chunk] + m_Columns[col].offset);
+        }
+
+        void* getComponentPtr(ComponentId typeId, size_t row) const;
+
+        template<typename T, typename... Args>
+        T& emplaceComponent(const EntityHandle& entity, Args&&... args) {
+            void* slot = getComponentPtr(getComponentId<T>(), getRow(entity));
+            return *new (slot) T(std::forward<Args>(args)...);
+        }
+
+        template<typename T>
+        T& getComponent(const EntityHandle& entity) const {
+            LGT_ASSERT_MSG(hasEntity(entity), "[Archetype::getComponent()] Entity does not have component.");
+            return *static_cast<T*>(getComponentPtr(getComponentId<T>(), getRow(entity)));
+        }
+
+        template<typename T>
+        bool entityHasComponent(const EntityHandle& entity) const {
+            return hasComponentType(getComponentId<T>()) && hasEntity(entity);
+        }
+
+    private:
+        Signature              m_Signature;
+        std::vector<Column>    m_Columns;     // sorted by component id
+        std::vector<int>       m_ColumnIndex; // component id -> column, -1 if absent
+        std::vector<std::byte*> m_Chunks;
+        size_t                 m_ChunkCapacity = 0; // rows per chunk
+        size_t                 m_ChunkBytes    = 0;
+        std::vector<EntityHandle> m_Entities; // row -> entity
+        EntityLocations*       m_Locations;   // entity -> (archetype, row), shared
+        const std::atomic<Tick>* m_WorldTick;
+        std::vector<Tick>      m_ChangedTicks; // [chunk * columns + column]
+        std::vector<Tick>      m_AddedTicks;
+        std::vector<Archetype*> m_AddEdges;   // component id -> archetype with it added, grown on demand
+        std::vector<Archetype*> m_RemoveEdges;// component id -> archetype with it removed
+
+        int   columnIndex(ComponentId typeId) const;
+        void* slot(const Column& column, size_t row) const;
+        void computeLayout();
+        void destroyRow(size_t row);
+        void removeRow(size_t row); // destroys the row and fills the hole with the last row
+        // Stamps every column of the chunks covering [first, first + count) as changed, and
+        // as added where previous (the rows' old signature, null for new rows) lacks it.
+        void stampRows(size_t first, size_t count, const Signature* previous);
+    };
+
+} // namespace lgt
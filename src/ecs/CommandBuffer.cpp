@@ -0,0 +1,191 @@
+#include "CommandBuffer.h"
+#include "ECS.h"
+
+#include <unordered_map>
+#include <new>
+#include <iterator>
+
+namespace lgt {
+
+    // Placeholders from createEntity() carry this generation, which Roster never hands out.
+    static bool isPlaceholder(EntityHandle entity) {
+        return entityGeneration(entity) == ReservedGeneration;
+    }
+
+    static size_t alignUp(size_t value, size_t align) {
+        return (value + align - 1) & ~(align - 1);
+    }
+
+    void CommandBuffer::BlockDeleter::operator()(std::byte* block) const {
+        ::operator delete(block, std::align_val_t(BLOCK_ALIGN));
+    }
+
+    CommandBuffer::~CommandBuffer()
+    {
+        destroyValues();
+    }
+
+    EntityHandle CommandBuffer::createEntity()
+    {
+        const EntityHandle placeholder = makeEntityHandle(m_Created++, ReservedGeneration);
+        m_Commands.push_back({ CommandType::Create, ComponentIdError, placeholder, nullptr });
+        return placeholder;
+    }
+
+    void CommandBuffer::destroyEntity(EntityHandle entity)
+    {
+        m_Commands.push_back({ CommandType::Destroy, ComponentIdError, entity, nullptr });
+    }
+
+    void* CommandBuffer::allocate(size_t size, size_t align)
+    {
+        LGT_ASSERT_MSG(align <= BLOCK_ALIGN, "[CommandBuffer::allocate] Component alignment too large.");
+
+        // oversized values get a block of their own, the current block stays in use
+        if (size > BLOCK_SIZE) {
+            m_LargeBlocks.emplace_back(static_cast<std::byte*>(::operator new(size, std::align_val_t(BLOCK_ALIGN))));
+            return m_LargeBlocks.back().get();
+        }
+
+        size_t offset = alignUp(m_BlockUsed, align);
+        if (m_Blocks.empty() || offset + size > BLOCK_SIZE) {
+            m_Blocks.emplace_back(static_cast<std::byte*>(::operator new(BLOCK_SIZE, std::align_val_t(BLOCK_ALIGN))));
+            offset = 0;
+        }
+        m_BlockUsed = offset + size;
+        return m_Blocks.back().get() + offset;
+    }
+
+    void CommandBuffer::append(CommandBuffer& other)
+    {
+        if (other.m_Commands.empty())
+            return;
+
+        m_Commands.reserve(m_Commands.size() + other.m_Commands.size());
+        for (Command command : other.m_Commands) {
+            if (isPlaceholder(command.entity))
+                command.entity = makeEntityHandle(entityIndex(command.entity) + m_Created, ReservedGeneration);
+            m_Commands.push_back(command);
+        }
+        m_Created += other.m_Created;
+
+        // keep our current block last so allocate() keeps filling it
+        m_Blocks.insert(m_Blocks.begin(), std::make_move_iterator(other.m_Blocks.begin()), std::make_move_iterator(other.m_Blocks.end()));
+        for (auto& block : other.m_LargeBlocks)
+            m_LargeBlocks.push_back(std::move(block));
+
+        other.m_Commands.clear();
+        other.m_Blocks.clear();
+        other.m_LargeBlocks.clear();
+        other.m_BlockUsed = BLOCK_SIZE;
+        other.m_Created = 0;
+    }
+
+    void CommandBuffer::flush(Roster& roster)
+    {
+        if (m_Commands.empty())
+            return;
+
+        struct Pending {
+            EntityHandle entity = NullEntity;
+            Signature    add{};
+            Signature    remove{};
+            bool         destroyed = false;
+            std::vector<ComponentManager::PendingValue> values{}; // last add per component wins
+        };
+
+        std::vector<EntityHandle> created(m_Created, NullEntity);
+        std::unordered_map<EntityHandle, size_t> pendingIndex;
+        std::vector<Pending> pending;
+
+        for (const Command& command : m_Commands) {
+            if (command.type == CommandType::Create) {
+                created[entityIndex(command.entity)] = roster.createEntity().getHandle();
+                continue;
+            }
+
+            const EntityHandle entity = isPlaceholder(command.entity) ? created[entityIndex(command.entity)] : command.entity;
+            if (!roster.isAlive(entity))
+                continue;
+
+            auto [it, inserted] = pendingIndex.try_emplace(entity, pending.size());
+            if (inserted)
+                pending.push_back({ entity });
+            Pending& state = pending[it->second];
+            if (state.destroyed)
+                continue;
+
+            auto dropValue = [&state](ComponentId id) {
+                std::erase_if(state.values, [id](const ComponentManager::PendingValue& v) { return v.id == id; });
+            };
+
+            switch (command.type) {
+            case CommandType::Destroy:
+                state.destroyed = true;
+                state.values.clear();
+                break;
+            case CommandType::Add:
+                state.add.set(command.component);
+                state.remove.reset(command.component);
+                dropValue(command.component);
+                state.values.push_back({ command.component, command.value });
+                break;
+            case CommandType::Remove:
+                state.remove.set(command.component);
+                state.add.reset(command.component);
+                dropValue(command.component);
+                break;
+            default:
+                break;
+            }
+        }
+
+        ComponentManager& components = roster.m_ComponenetManager;
+        std::vector<ComponentManager::EntityChange> changes;
+        std::vector<ComponentManager::PendingValue> values;
+        std::vector<EntityHandle> destroyed;
+        changes.reserve(pending.size());
+
+        for (Pending& state : pending) {
+            if (state.destroyed) {
+                destroyed.push_back(state.entity);
+                continue;
+            }
+
+            Signature target = components.getEntitySignature(state.entity) | state.add;
+            state.remove.forEach([&target](size_t bit) { target.reset(bit); });
+
+            if (target == components.getEntitySignature(state.entity) && state.values.empty())
+                continue;
+
+            changes.push_back({ state.entity, target, values.size(), state.values.size() });
+            values.insert(values.end(), state.values.begin(), state.values.end());
+        }
+
+        roster.destroyEntities(destroyed);
+        components.applyChanges(changes, values);
+        clear();
+    }
+
+    void CommandBuffer::destroyValues()
+    {
+        for (const Command& command : m_Commands) {
+            if (command.type == CommandType::Add)
+                ComponentRegistry::getInfo(command.component).destroy(command.value);
+        }
+    }
+
+    void CommandBuffer::clear()
+    {
+        destroyValues();
+        m_Commands.clear();
+        m_Created = 0;
+
+        // keep one block around for the next frame
+        m_LargeBlocks.clear();
+        if (m_Blocks.size() > 1)
+            m_Blocks.erase(m_Blocks.begin(), m_Blocks.end() - 1);
+        m_BlockUsed = m_Blocks.empty() ? BLOCK_SIZE : 0;
+    }
+
+} // namespace lgt
@@ -0,0 +1,85 @@
+#pragma once
+#include "Defines.h"
+#include "ComponentRegistry.h"
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <utility>
+#include <type_traits>
+
+namespace lgt {
+
+    class Roster;
+
+    // Records structural changes (create/destroy/add/remove) so they can be made while
+    // views are being iterated, then applies them all at one sync point with flush().
+    // A buffer is not thread-safe; give every thread its own (the Scheduler does) and
+    // merge them with append() before flushing.
+    class CommandBuffer {
+    public:
+        CommandBuffer() = default;
+        ~CommandBuffer();
+
+        CommandBuffer(const CommandBuffer&) = delete;
+        CommandBuffer& operator=(const CommandBuffer&) = delete;
+
+        // Returns a placeholder handle that can be used with the other commands of this
+        // buffer; the real entity is created during flush().
+        EntityHandle createEntity();
+        void destroyEntity(EntityHandle entity);
+
+        template<typename T>
+        void addComponent(EntityHandle entity, T component) {
+            const ComponentInfo& info = ComponentRegistry::registerComponent<T>();
+            void* value = allocate(info.size, info.align);
+            new (value) T(std::move(component));
+            m_Commands.push_back({ CommandType::Add, info.id, entity, value });
+        }
+
+        template<typename T>
+        void removeComponent(EntityHandle entity) {
+            m_Commands.push_back({ CommandType::Remove, getComponentId<T>(), entity, nullptr });
+        }
+
+        // Moves the other buffer's commands after ours; other is left empty.
+        void append(CommandBuffer& other);
+
+        // Applies every command in recording order semantics : per entity the adds and
+        // removes are folded into one target signature, then entities are migrated in
+        // batches per (source, target) archetype pair. Commands on dead entities are dropped.
+        void flush(Roster& roster);
+        void clear();
+
+        size_t size()  const { return m_Commands.size(); }
+        bool   empty() const { return m_Commands.empty(); }
+
+    private:
+        enum class CommandType : uint8_t { Create, Destroy, Add, Remove };
+
+        struct Command {
+            CommandType  type;
+            ComponentId  component;
+            EntityHandle entity;
+            void*        value; // Add only, constructed in the arena
+        };
+
+        struct BlockDeleter {
+            void operator()(std::byte* block) const;
+        };
+        using Block = std::unique_ptr<std::byte[], BlockDeleter>;
+
+        static constexpr size_t BLOCK_SIZE  = 16 * 1024;
+        static constexpr size_t BLOCK_ALIGN = 64;
+
+        std::vector<Command> m_Commands;
+        std::vector<Block>   m_Blocks;      // value arena, never reallocated so values stay put
+        std::vector<Block>   m_LargeBlocks; // one per value bigger than BLOCK_SIZE
+        size_t               m_BlockUsed = BLOCK_SIZE;
+        uint32_t             m_Created   = 0; // placeholders handed out
+
+        void* allocate(size_t size, size_t align);
+        void  destroyValues();
+    };
+
+} // namespace lgt
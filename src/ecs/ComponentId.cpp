@@ -1,12 +1,16 @@
 #include "ComponentId.h"
 #include "ComponentManager.h"
 
+#include <atomic>
+
 namespace lgt {
 
     ComponentId getUniqueComponentId() {
-        static ComponentId uniqueid = 0;
-        ComponentManager::ComponentCount = uniqueid;
-        return uniqueid++;
+        static std::atomic<ComponentId> uniqueid{ 0 };
+        const ComponentId id = uniqueid.fetch_add(1);
+        LGT_ASSERT_MSG(id < MAX_COMPONENTS, "[getUniqueComponentId] Too many component types, raise LGT_MAX_COMPONENTS.");
+        ComponentManager::ComponentCount = id;
+        return id;
     }
 
     size_t getComponentTypeCount()
@@ -1,6 +1,8 @@
 #pragma once
 #include "Defines.h"
 
+#include <type_traits>
+
 namespace lgt {
 
     ComponentId LGT_API getUniqueComponentId();
@@ -11,4 +13,12 @@ namespace lgt {
         static ComponentId typeId = getUniqueComponentId();
         return typeId;
     }
+
+    // Signature with the bit of every T set (const T counts as T).
+    template<typename... Ts>
+    inline Signature makeSignature() {
+        Signature signature;
+        (signature.set(getComponentId<std::remove_const_t<Ts>>()), ...);
+        return signature;
+    }
 }
\ No newline at end of file
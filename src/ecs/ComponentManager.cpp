@@ -1,94 +1,300 @@
 #include "Core.h"
 #include "ComponentManager.h"
-#include "ComponentRegistry.h"
 
 namespace lgt {
 
-    size_t ComponentManager::ComponentCount = 0;
-
-    // class  Archtypes
-    bool Archetype::hasComponentType(ComponentId typeId) const {
-        return m_ComponentPools.find(typeId) != m_ComponentPools.end();
-    }
-
-    void Archetype::addEntity(const EntityHandle& entity)
-    {
-        if (!hasEntity(entity))
-            m_Entities.push_back(entity);
-    }
-    
-    bool Archetype::removeEntity(EntityHandle entity)
-    {
-        if (hasEntity(entity)) {
-            m_Entities.erase(std::remove(m_Entities.begin(), m_Entities.end(), entity), m_Entities.end());
-            return true;
-        }
-        return false;
-    }
-
-    bool Archetype::hasEntity(const EntityHandle& entity) const {
-        return std::find(m_Entities.begin(), m_Entities.end(), entity) != m_Entities.end();
-    }
-
- const std::vector<EntityHandle>& Archetype::getEntities() const
- {
-     return m_Entities;
- }
+    std::atomic<size_t> ComponentManager::ComponentCount{ 0 };
 
  // class ComponentManager
 
  std::shared_ptr<Archetype> ComponentManager::getOrCreateArchetype(const Signature& sig) {
      auto it = m_Archetypes.find(sig);
      if (it == m_Archetypes.end()) {
-         auto newArchetype = std::make_shared<Archetype>();
+         auto newArchetype = std::make_shared<Archetype>(sig, m_Tick, m_Locations);
          m_Archetypes[sig] = newArchetype;
+         m_SignatureIndex.add(sig, newArchetype.get());
+         std::lock_guard<std::shared_mutex> lock(m_QueryMutex);
+         for (auto& [query, matches] : m_QueryCache) {
+             if (SignatureIndex::matches(sig, query.include, query.exclude))
+                 matches.push_back(newArchetype.get());
+         }
          return newArchetype;
      }
      return it->second;
  }
 
- void ComponentManager::moveEntity(const Signature& oldSig, const Signature& newSig, const EntityHandle& entity) {
-     if (oldSig == newSig) return;
-     const auto oldArch = getOrCreateArchetype(oldSig);
-     const auto newArch = getOrCreateArchetype(newSig);
+ Archetype* ComponentManager::getAddTarget(Archetype* src, ComponentId cid) {
+     if (Archetype* cached = src->getAddEdge(cid))
+         return cached;
+
+     Signature sig = src->getSignature();
+     sig.set(cid);
+     Archetype* dst = getOrCreateArchetype(sig).get();
+     src->setAddEdge(cid, dst);
+     dst->setRemoveEdge(cid, src);
+     return dst;
+ }
+
+ Archetype* ComponentManager::getRemoveTarget(Archetype* src, ComponentId cid) {
+     if (Archetype* cached = src->getRemoveEdge(cid))
+         return cached;
+
+     Signature sig = src->getSignature();
+     sig.reset(cid);
+     Archetype* dst = getOrCreateArchetype(sig).get();
+     src->setRemoveEdge(cid, dst);
+     dst->setAddEdge(cid, src);
+     return dst;
+ }
+
+ Archetype* ComponentManager::getEntityArchetype(const EntityHandle& entity) {
+     if (const EntityLocation* location = m_Locations.find(entity))
+         return location->archetype;
 
+     Archetype* empty = getOrCreateArchetype(Signature()).get();
+     empty->addEntity(entity);
+     return empty;
+ }
+
+ std::vector<ComponentManager::MigratedBlock> ComponentManager::migrate(std::span<const EntityHandle> entities, ComponentId cid, bool add) {
+     // (source archetype, row) of every entity that actually changes archetype
+     std::vector<std::pair<Archetype*, size_t>> moves;
+     moves.reserve(entities.size());
+     for (const EntityHandle& entity : entities) {
+         if (!add && !m_Locations.find(entity)) continue;
+         Archetype* src = getEntityArchetype(entity);
+         if (src->hasComponentType(cid) != add)
+             moves.emplace_back(src, m_Locations.find(entity)->row);
+     }
+     std::sort(moves.begin(), moves.end());
+     moves.erase(std::unique(moves.begin(), moves.end()), moves.end());
+
+     std::vector<MigratedBlock> blocks;
+     std::vector<size_t> rows;
+     for (size_t begin = 0; begin < moves.size();) {
+         Archetype* src = moves[begin].first;
+         size_t end = begin;
+         rows.clear();
+         while (end < moves.size() && moves[end].first == src)
+             rows.push_back(moves[end++].second);
+
+         Archetype* dst = add ? getAddTarget(src, cid) : getRemoveTarget(src, cid);
+         if (!add)
+             notifyRemoved(*src, rows, Signature().set(cid));
+         const size_t firstRow = src->migrateRows(*dst, rows);
+         blocks.push_back({ dst, firstRow, rows.size() });
+         begin = end;
+     }
+     return blocks;
+ }
 
-     for (ComponentId i = 0; i <= ComponentManager::ComponentCount; i++) {
-         if (oldSig.test(i) && newSig.test(i)) {
-             auto moveFunc = ComponentRegistry::getMovefunc(i);
-             if (moveFunc) moveFunc(entity, oldArch, newArch);
+ void ComponentManager::applyChanges(std::vector<EntityChange>& changes, std::span<const PendingValue> values) {
+     struct Move {
+         Archetype*    src;
+         Archetype*    dst;
+         EntityChange* change;
+     };
+
+     std::vector<Move> moves;
+     moves.reserve(changes.size());
+     Archetype* lastSrc = nullptr;
+     Archetype* lastDst = nullptr;
+     for (EntityChange& change : changes) {
+         Archetype* src = getEntityArchetype(change.entity);
+         // consecutive changes usually share a transition, skip the signature lookup then
+         if (src != lastSrc || lastDst->getSignature() != change.target) {
+             lastSrc = src;
+             lastDst = src->getSignature() == change.target ? src : getOrCreateArchetype(change.target).get();
          }
-         else if (oldSig.test(i) && !newSig.test(i)) {
-             auto removeFunc = ComponentRegistry::getRemovefunc(i);
-             if (removeFunc) removeFunc(entity, oldArch);
+         moves.push_back({ src, lastDst, &change });
+     }
+     std::stable_sort(moves.begin(), moves.end(), [](const Move& a, const Move& b) {
+         return a.src != b.src ? a.src < b.src : a.dst < b.dst;
+     });
+
+     std::vector<size_t> rows;
+     for (size_t begin = 0; begin < moves.size();) {
+         Archetype* src = moves[begin].src;
+         Archetype* dst = moves[begin].dst;
+         size_t end = begin;
+         while (end < moves.size() && moves[end].src == src && moves[end].dst == dst)
+             end++;
+
+         // rows are read per group : an earlier group may have swap-removed from src
+         size_t firstRow = 0;
+         if (src != dst) {
+             rows.clear();
+             for (size_t i = begin; i < end; i++)
+                 rows.push_back(m_Locations.find(moves[i].change->entity)->row);
+             notifyRemoved(*src, rows, src->getSignature() ^ (src->getSignature() & dst->getSignature()));
+             firstRow = src->migrateRows(*dst, rows);
+         }
+
+         for (size_t i = begin; i < end; i++) {
+             const EntityChange& change = *moves[i].change;
+             const size_t row = (src != dst) ? firstRow + (i - begin) : m_Locations.find(change.entity)->row;
+
+             for (size_t v = change.firstValue; v < change.firstValue + change.valueCount; v++) {
+                 const ComponentInfo& info = ComponentRegistry::getInfo(values[v].id);
+                 void* slot = dst->getComponentPtr(values[v].id, row);
+                 if (src->hasComponentType(values[v].id)) {
+                     info.destroy(slot); // overwrite of a component the entity kept
+                     dst->markRowChanged(values[v].id, row);
+                 }
+                 info.moveConstruct(slot, values[v].value);
+             }
          }
+         if (src != dst)
+             notifyAdded(*dst, firstRow, end - begin, dst->getSignature() ^ (src->getSignature() & dst->getSignature()));
+         begin = end;
      }
+ }
 
-     oldArch->removeEntity(entity);
-     newArch->addEntity(entity);
+ Archetype* ComponentManager::placeEntities(const Signature& signature, std::span<const EntityHandle> entities, size_t& firstRow) {
+     Archetype* dst = getOrCreateArchetype(signature).get();
+     firstRow = dst->addEntities(entities);
+     return dst;
  }
 
  bool ComponentManager::removeAllComponents(const EntityHandle& entity) {
-     if (!m_EntityToSignature.count(entity)) return false;
-
-     Signature oldSig = m_EntityToSignature[entity];
-     Signature emptySig;
-     if (const auto oldArch = getOrCreateArchetype(oldSig)) {
-         for (ComponentId i = 0; i <= ComponentManager::ComponentCount; i++) {
-             if (oldSig.test(i) && i < ComponentManager::ComponentCount) {
-                 auto removeFunc = ComponentRegistry::getRemovefunc(i);
-                 if (removeFunc) removeFunc(entity, oldArch);
-             }
+     const EntityLocation* location = m_Locations.find(entity);
+     if (!location) return false;
+
+     const size_t row = location->row;
+     notifyRemoved(*location->archetype, { &row, 1 }, location->archetype->getSignature());
+     location->archetype->removeEntity(entity);
+     // the entity is detached from every archetype until it gets a component again
+     m_Locations.erase(entity);
+     return true;
+ }
+
+ void ComponentManager::removeAllComponents(std::span<const EntityHandle> entities) {
+     std::vector<std::pair<Archetype*, size_t>> rows;
+     rows.reserve(entities.size());
+     for (const EntityHandle& entity : entities) {
+         const EntityLocation* location = m_Locations.find(entity);
+         if (!location) continue;
+         rows.emplace_back(location->archetype, location->row);
+         // removeRows() swaps from the back, so a pending entity's record is never rewritten
+         m_Locations.erase(entity);
+     }
+     std::sort(rows.begin(), rows.end());
+
+     std::vector<size_t> group;
+     for (size_t begin = 0; begin < rows.size();) {
+         Archetype* archetype = rows[begin].first;
+         group.clear();
+         while (begin < rows.size() && rows[begin].first == archetype)
+             group.push_back(rows[begin++].second);
+         notifyRemoved(*archetype, group, archetype->getSignature());
+         archetype->removeRows(group);
+     }
+ }
+
+ ObserverId ComponentManager::addObserver(ComponentId cid, AddObserver added, RemoveObserver removed) {
+     if (added) m_ObservedAdds.set(cid);
+     if (removed) m_ObservedRemoves.set(cid);
+     m_Observers.push_back({ m_NextObserver, cid, std::move(added), std::move(removed) });
+     return m_NextObserver++;
+ }
+
+ void ComponentManager::removeObserver(ObserverId id) {
+     std::erase_if(m_Observers, [id](const Observer& observer) { return observer.id == id; });
+     m_ObservedAdds.reset();
+     m_ObservedRemoves.reset();
+     for (const Observer& observer : m_Observers) {
+         if (observer.added) m_ObservedAdds.set(observer.component);
+         if (observer.removed) m_ObservedRemoves.set(observer.component);
+     }
+ }
+
+ void ComponentManager::notifyAdded(Archetype& archetype, size_t firstRow, size_t count, const Signature& components) {
+     if (count == 0 || !components.intersects(m_ObservedAdds))
+         return;
+
+     // entities and columns are only contiguous inside a chunk, so one call per chunk slice
+     const size_t capacity = archetype.getChunkCapacity();
+     const EntityHandle* entities = archetype.getEntities().data();
+     for (const Observer& observer : m_Observers) {
+         if (!observer.added || !components.test(observer.component))
+             continue;
+         for (size_t row = firstRow; row < firstRow + count;) {
+             const size_t end = std::min(firstRow + count, (row / capacity + 1) * capacity);
+             observer.added({ entities + row, end - row }, archetype.getComponentPtr(observer.component, row));
+             row = end;
          }
      }
+ }
 
-     getArchetype(oldSig)->removeEntity(entity);
-     m_EntityToSignature[entity] = emptySig;
-     return true;
+ void ComponentManager::notifyRemoved(Archetype& archetype, std::span<const size_t> rows, const Signature& components) {
+     if (rows.empty() || !components.intersects(m_ObservedRemoves))
+         return;
+
+     std::vector<EntityHandle> entities(rows.size());
+     for (size_t i = 0; i < rows.size(); i++)
+         entities[i] = archetype.getEntities()[rows[i]];
+     for (const Observer& observer : m_Observers) {
+         if (observer.removed && components.test(observer.component))
+             observer.removed(entities, archetype, rows);
+     }
+ }
+
+ MemoryStats ComponentManager::getMemoryStats() const {
+     MemoryStats stats;
+     stats.perArchetype.reserve(m_Archetypes.size());
+     for (const auto& [signature, archetype] : m_Archetypes) {
+         ArchetypeMemoryStats archetypeStats = archetype->getMemoryStats();
+         stats.archetypes++;
+         stats.emptyArchetypes += archetypeStats.entities == 0 ? 1 : 0;
+         stats.entities += archetypeStats.entities;
+         stats.chunks += archetypeStats.chunks;
+         stats.bytesReserved += archetypeStats.bytesReserved;
+         stats.bytesUsed += archetypeStats.bytesUsed;
+         stats.perArchetype.push_back(std::move(archetypeStats));
+     }
+     std::sort(stats.perArchetype.begin(), stats.perArchetype.end(), [](const ArchetypeMemoryStats& a, const ArchetypeMemoryStats& b) {
+         return a.bytesReserved > b.bytesReserved;
+     });
+     stats.indexBytes = m_Locations.getReservedBytes();
+     return stats;
+ }
+
+ size_t ComponentManager::compact() {
+     size_t released = 0;
+     std::vector<Archetype*> empty;
+     for (auto& [signature, archetype] : m_Archetypes) {
+         if (archetype->getSize() == 0)
+             empty.push_back(archetype.get());
+         else
+             released += archetype->shrinkToFit();
+     }
+     if (empty.empty())
+         return released;
+
+     // unhook the archetypes everywhere before they are destroyed; views keep pointing
+     // at the same (filtered) query vectors
+     std::sort(empty.begin(), empty.end());
+     auto isEmpty = [&empty](Archetype* archetype) { return std::binary_search(empty.begin(), empty.end(), archetype); };
+     {
+         std::lock_guard<std::shared_mutex> lock(m_QueryMutex);
+         for (auto& [query, matches] : m_QueryCache)
+             std::erase_if(matches, isEmpty);
+     }
+     for (auto& [signature, archetype] : m_Archetypes)
+         archetype->clearEdges();
+     for (Archetype* archetype : empty) {
+         m_SignatureIndex.remove(archetype);
+         released += archetype->getMemoryStats().bytesReserved + sizeof(Archetype);
+         const Signature signature = archetype->getSignature(); // the key dies with the archetype
+         m_Archetypes.erase(signature);
+     }
+     return released;
  }
 
  const Signature& ComponentManager::getEntitySignature(const EntityHandle& entity) {
-     return m_EntityToSignature[entity];
+     static const Signature empty;
+     const EntityLocation* location = m_Locations.find(entity);
+     return location ? location->archetype->getSignature() : empty;
  }
 
  std::unordered_map<Signature, std::shared_ptr<Archetype>>& ComponentManager::getArchetypes() {
@@ -100,5 +306,22 @@ namespace lgt {
      return (it != m_Archetypes.end()) ? it->second : nullptr;
  }
 
+ const std::vector<Archetype*>& ComponentManager::getMatchingArchetypes(const Signature& required, const Signature& excluded) {
+     const Query query{ required, excluded };
+     {
+         std::shared_lock<std::shared_mutex> lock(m_QueryMutex);
+         auto it = m_QueryCache.find(query);
+         if (it != m_QueryCache.end())
+             return it->second; // map nodes never move, the reference outlives the lock
+     }
+
+     // first use of this query : scan once, getOrCreateArchetype() keeps it current afterwards.
+     // Another thread may have added it in between, emplace() then keeps that entry.
+     std::lock_guard<std::shared_mutex> lock(m_QueryMutex);
+     std::vector<Archetype*> matches;
+     m_SignatureIndex.match(required, excluded, matches);
+     return m_QueryCache.emplace(query, std::move(matches)).first->second;
+ }
+
 
 } // namespace lgt
@@ -2,223 +2,270 @@
 #include "Defines.h"
 #include "ComponentRegistry.h"
 #include "ComponentId.h"
+#include "Archetype.h"
+#include "View.h"
+#include "SignatureIndex.h"
 
 #include <vector>
+#include <span>
 #include <unordered_map>
 #include <typeindex>
 #include <memory>
+#include <atomic>
+#include <shared_mutex>
+#include <mutex>
 #include <algorithm>
 #include <iostream>
 #include <stdexcept>
+#include <functional>
 
 namespace lgt {
 
-    class IComponentPool {
-    public:
-        virtual bool hasComponent(const EntityHandle& entity) const = 0;
-        virtual const std::vector<EntityHandle>& getEntitiesWithComponent() const = 0;
-        virtual ~IComponentPool() = default;
-    };
-
-    template<typename T>
-    class ComponentPool : public IComponentPool {
+    class LGT_API ComponentManager {
     private:
-        std::vector<T> m_Components;
-        std::unordered_map<EntityHandle, size_t> m_EntityToIndex;
-        std::vector<EntityHandle> m_IndexToEntity;
-
-    public:
-        void addComponent(const EntityHandle& entity, const T& component) {
-            auto it = m_EntityToIndex.find(entity);
-            if (it == m_EntityToIndex.end()) {
-                size_t newIndex = m_Components.size();
-                m_Components.push_back(component);
-                m_EntityToIndex[entity] = newIndex;
-                m_IndexToEntity.push_back(entity);
-            }
-            else {
-                m_Components[it->second] = component;
-            }
-        }
+        EntityLocations m_Locations;     // entity -> (archetype, row), kept current by the archetypes
+        std::unordered_map<Signature, Ref<Archetype>> m_Archetypes;
+        SignatureIndex m_SignatureIndex; // every archetype signature, for query scans
+        std::atomic<Tick> m_Tick{ 1 };   // stamped into chunk columns on every write
+
+        struct Query {
+            Signature include;
+            Signature exclude;
+            bool operator==(const Query& other) const { return include == other.include && exclude == other.exclude; }
+        };
+        struct QueryHash {
+            size_t operator()(const Query& query) const { return query.include.hash() ^ (query.exclude.hash() * 31); }
+        };
+        // query -> matching archetypes; extended when an archetype is created. Systems
+        // build views from worker threads, so a first-time query takes the lock exclusively.
+        std::unordered_map<Query, std::vector<Archetype*>, QueryHash> m_QueryCache;
+        std::shared_mutex m_QueryMutex;
+
+        // A block of rows that landed in one archetype during a batched migration.
+        struct MigratedBlock {
+            Archetype* archetype;
+            size_t     firstRow;
+            size_t     count;
+        };
+
+        // Type-erased observer callbacks. An add observer gets one chunk slice (its entities
+        // and the first component of the column), a remove observer the rows about to go.
+        using AddObserver    = std::function<void(std::span<const EntityHandle> entities, void* column)>;
+        using RemoveObserver = std::function<void(std::span<const EntityHandle> entities, const Archetype& archetype, std::span<const size_t> rows)>;
+
+        struct Observer {
+            ObserverId     id;
+            ComponentId    component;
+            AddObserver    added;
+            RemoveObserver removed;
+        };
+        std::vector<Observer> m_Observers;
+        Signature  m_ObservedAdds;    // components with at least one add / remove observer,
+        Signature  m_ObservedRemoves; // so unobserved batches cost one mask test
+        ObserverId m_NextObserver = 0;
+
+        ObserverId addObserver(ComponentId cid, AddObserver added, RemoveObserver removed);
+        // Fires the remove observers of components for those rows, before they are destroyed.
+        void notifyRemoved(Archetype& archetype, std::span<const size_t> rows, const Signature& components);
 
-        bool removeComponent(const EntityHandle& entity) {
-            auto it = m_EntityToIndex.find(entity);
-            if (it != m_EntityToIndex.end()) {
-                size_t indexToRemove = it->second;
-                EntityHandle lastEntity = m_IndexToEntity.back();
-
-                m_Components[indexToRemove] = std::move(m_Components.back());
-                m_EntityToIndex[lastEntity] = indexToRemove;
-                m_IndexToEntity[indexToRemove] = lastEntity;
-
-                m_Components.pop_back();
-                m_IndexToEntity.pop_back();
-                m_EntityToIndex.erase(it);
-                return true;
+        Ref<Archetype> getOrCreateArchetype(const Signature& sig);
+        Archetype* getAddTarget(Archetype* src, ComponentId cid);
+        Archetype* getRemoveTarget(Archetype* src, ComponentId cid);
+        // Archetype currently holding the entity; a fresh entity is parked in the empty archetype.
+        Archetype* getEntityArchetype(const EntityHandle& entity);
+        // Groups the entities by archetype and moves each group along the add/remove edge
+        // of cid with one column pass per group. Entities already in the right state are skipped.
+        std::vector<MigratedBlock> migrate(std::span<const EntityHandle> entities, ComponentId cid, bool add);
+
+        // Copy-constructs value into rows [first, first + count) of T's column, chunk by chunk.
+        template<typename T>
+        static void constructRows(Archetype& archetype, size_t first, size_t count, const T& value) {
+            const size_t capacity = archetype.getChunkCapacity();
+            for (size_t row = first; row < first + count;) {
+                const size_t chunk = row / capacity;
+                const size_t end = std::min(first + count, (chunk + 1) * capacity);
+                T* column = archetype.template getColumn<T>(chunk);
+                for (; row < end; row++)
+                    new (column + row % capacity) T(value);
             }
-            return false;
-        }
-
-        T& getComponent(const EntityHandle& entity) {
-            auto it = m_EntityToIndex.find(entity);
-            LGT_ASSERT_MSG(!(it == m_EntityToIndex.end()),"[ComponentPool::getComponent] Entity not found in pool.");
-            return m_Components[it->second];
         }
 
-        bool hasComponent(const EntityHandle& entity) const override {
-            return m_EntityToIndex.find(entity) != m_EntityToIndex.end();
-        }
-
-        std::vector<T>& getAllComponents() {
-            return m_Components;
-        }
-
-        const std::vector<EntityHandle>& getEntitiesWithComponent() const override {
-            return m_IndexToEntity;
-        }
-
-        size_t getSize() const {
-            return m_Components.size();
-        }
-    };
-
-    struct Archetype {
     public:
 
-        bool hasComponentType(ComponentId typeId) const;
-        bool hasEntity(const EntityHandle& entity) const;
-        void addEntity(const EntityHandle& entity);
-        bool removeEntity(EntityHandle entity);
-        const std::vector<EntityHandle>& getEntities() const;
+        // A constructed component value waiting to be moved into an entity's row.
+        struct PendingValue {
+            ComponentId id;
+            void*       value; // left moved-from, the owner still destroys it
+        };
+
+        // Final state of one entity after a batch of deferred structural changes.
+        struct EntityChange {
+            EntityHandle entity;
+            Signature    target;
+            size_t       firstValue; // range in the values span passed to applyChanges()
+            size_t       valueCount;
+        };
+
+        static std::atomic<size_t> ComponentCount;
+
+        // Change detection : writes are stamped with the current tick and a query filtered
+        // with changed<T>(since) / added<T>(since) only visits chunks stamped after since.
+        // The Scheduler advances the tick before every system run.
+        Tick getTick() const { return m_Tick.load(std::memory_order_relaxed); }
+        Tick advanceTick() { return m_Tick.fetch_add(1, std::memory_order_relaxed) + 1; }
+
+        // Moves every entity to the archetype of its target signature and moves the pending
+        // values into place. Entities sharing a (source, target) archetype pair migrate
+        // together in one column pass. Each entity may appear at most once.
+        void applyChanges(std::vector<EntityChange>& changes, std::span<const PendingValue> values);
 
-        template<typename T>
-        void addComponent(const EntityHandle& entity, const T& component) {
-            getOrCreateComponentPool<T>()->addComponent(entity, component);
-        }
+        bool removeAllComponents(const EntityHandle& entity);
+        // removeAllComponents() for many entities, one removal pass per archetype.
+        void removeAllComponents(std::span<const EntityHandle> entities);
+        const Signature& getEntitySignature(const EntityHandle& entity);
+        std::unordered_map<Signature, std::shared_ptr<Archetype>>& getArchetypes();
 
-        template<typename T>
-        bool removeComponent(const EntityHandle& entity) {
-            auto it = m_ComponentPools.find(getComponentId<T>());
-            LGT_ASSERT_MSG(!(it == m_ComponentPools.end()), "[Archetype::removeComponent] Component pool not found.\n");
-            auto pool = std::static_pointer_cast<ComponentPool<T>>(it->second);
-            return pool->removeComponent(entity);
+        // Bytes reserved / used per archetype and per component column, and chunk occupancy.
+        MemoryStats getMemoryStats() const;
+        // Gives memory back after mass destroys or a level unload : trims every archetype
+        // to its live rows and deletes the archetypes left without entities (with their
+        // cached edges and query matches). Not to be called while a view is iterated.
+        // Returns the bytes released.
+        size_t compact();
+        std::shared_ptr<Archetype> getArchetype(const Signature& sig) const;
+        // Archetypes whose signature contains every bit of required and none of excluded
+        // (cached per query).
+        const std::vector<Archetype*>& getMatchingArchetypes(const Signature& required, const Signature& excluded = Signature());
+
+        // excluded filters out archetypes holding any of those types, e.g. makeSignature<Hidden>()
+        template<typename... Ts>
+        View<Ts...> view(const Signature& excluded = Signature()) {
+            return View<Ts...>(getMatchingArchetypes(makeSignature<Ts...>(), excluded));
         }
 
-        template<typename T>
-        T& getComponent(const EntityHandle& entity) const {
-            auto it = m_ComponentPools.find(getComponentId<T>());
-            LGT_ASSERT_MSG(!(it == m_ComponentPools.end()), "[Archetype::getComponent()] Component pool not found.");
-            Ref<ComponentPool<T>> pool = std::static_pointer_cast<ComponentPool<T>>(it->second);
-            LGT_ASSERT_MSG(pool->hasComponent(entity), "[Archetype::getComponent()] Entity does not have component.");
-            return pool->getComponent(entity);
+        // Observers : batched callbacks for entities that gained or lost T, e.g. to keep a
+        // spatial index or GPU slots in sync with Renderable.
+        //   onAdd<T>(fn(std::span<const EntityHandle>, std::span<T>))
+        //     once the values are in place, one call per chunk slice of the new rows.
+        //   onRemove<T>(fn(std::span<const EntityHandle>, std::span<T* const>))
+        //     before the values are destroyed, one call per source archetype.
+        // Batches are as large as the structural change that produced them : a whole
+        // CommandBuffer::flush(), spawn / destroyEntities, the span overloads or a snapshot
+        // load; single-entity calls give batches of one. Observers run on the thread making
+        // the change and must not make structural changes themselves (use a CommandBuffer).
+        template<typename T, typename Func>
+        ObserverId onAdd(Func&& fn) {
+            ComponentRegistry::registerComponent<T>();
+            return addObserver(getComponentId<T>(),
+                [fn = std::forward<Func>(fn)](std::span<const EntityHandle> entities, void* column) {
+                    fn(entities, std::span<T>(static_cast<T*>(column), entities.size()));
+                }, nullptr);
         }
 
-        template<typename T>
-        std::vector<T>& getComponentPoolData() {
-            auto it = m_ComponentPools.find(getComponentId<T>());
-            LGT_ASSERT_MSG(!(it == m_ComponentPools.end()), "[Archetype::getComponentPoolData()] Component pool did not found");
-            return std::static_pointer_cast<ComponentPool<T>>(it->second)->getAllComponents();
+        template<typename T, typename Func>
+        ObserverId onRemove(Func&& fn) {
+            ComponentRegistry::registerComponent<T>();
+            const ComponentId cid = getComponentId<T>();
+            return addObserver(cid, nullptr,
+                [fn = std::forward<Func>(fn), cid](std::span<const EntityHandle> entities, const Archetype& archetype, std::span<const size_t> rows) {
+                    std::vector<T*> components(rows.size());
+                    for (size_t i = 0; i < rows.size(); i++)
+                        components[i] = static_cast<T*>(archetype.getComponentPtr(cid, rows[i]));
+                    fn(entities, std::span<T* const>(components));
+                });
         }
 
-        template<typename T>
-        bool entityHasComponent(const EntityHandle& entity) const {
-            auto it = m_ComponentPools.find(getComponentId<T>());
-            if (it != m_ComponentPools.end()) {
-                return it->second->hasComponent(entity);
-            }
-            return false;
+        void removeObserver(ObserverId id);
+
+        // Fires the add observers of components for rows [firstRow, firstRow + count).
+        // Called by every path that appends rows with new components (also Snapshot::load).
+        void notifyAdded(Archetype& archetype, size_t firstRow, size_t count, const Signature& components);
+
+        // Appends fresh entities (no components yet) to the archetype of signature in one
+        // block. Every column of rows [firstRow, firstRow + entities.size()) is left
+        // unconstructed for the caller to fill.
+        Archetype* placeEntities(const Signature& signature, std::span<const EntityHandle> entities, size_t& firstRow);
+
+        // Places fresh entities (no components yet) straight into the archetype of Ts, with
+        // a copy of prototype in every row; no per-entity migration.
+        template<typename... Ts>
+        void spawn(std::span<const EntityHandle> entities, const Ts&... prototype) {
+            (ComponentRegistry::registerComponent<Ts>(), ...);
+            size_t first = 0;
+            Archetype* dst = placeEntities(makeSignature<Ts...>(), entities, first);
+            (constructRows<Ts>(*dst, first, entities.size(), prototype), ...);
+            notifyAdded(*dst, first, entities.size(), makeSignature<Ts...>());
         }
 
-    private:
-        std::unordered_map<ComponentId,std::shared_ptr<IComponentPool>> m_ComponentPools;
-        std::vector<EntityHandle> m_Entities;
-        
         template<typename T>
-        Ref<ComponentPool<T>> getOrCreateComponentPool() {
-            ComponentId typeId = getComponentId<T>();
-            auto it = m_ComponentPools.find(typeId);
-
-            if (it == m_ComponentPools.end()) {
-                auto newPool = std::make_shared<ComponentPool<T>>();
-                m_ComponentPools[typeId] = newPool;
-                return newPool;
+        void addComponent(const EntityHandle& entity, const T& component) {
+            ComponentRegistry::registerComponent<T>();
+            Archetype* src = getEntityArchetype(entity);
+            if (src->hasComponentType(getComponentId<T>())) {
+                getComponent<T>(entity) = component;
+                return;
             }
-            return std::static_pointer_cast<ComponentPool<T>>(it->second);
-        }
-        
-        template<typename T>
-        Ref<ComponentPool<T>> getComponentPool() {
-
 
+            Archetype* dst = getAddTarget(src, getComponentId<T>());
+            size_t row = m_Locations.find(entity)->row;
+            row = src->migrateRows(*dst, { &row, 1 });
+            new (dst->getComponentPtr(getComponentId<T>(), row)) T(component);
+            notifyAdded(*dst, row, 1, Signature().set(getComponentId<T>()));
         }
-    };
-
-    class LGT_API ComponentManager {
-    private:
-        std::unordered_map<EntityHandle, Signature> m_EntityToSignature;
-        std::unordered_map<Signature, Ref<Archetype>> m_Archetypes;
-
-        void moveEntity(const Signature& oldSig, const Signature& newSig, const EntityHandle& entity);
-        Ref<Archetype> getOrCreateArchetype(const Signature& sig);
-
-    public:
-
-        static size_t ComponentCount;
-
-        bool removeAllComponents(const EntityHandle& entity);
-        const Signature& getEntitySignature(const EntityHandle& entity);
-        std::unordered_map<Signature, std::shared_ptr<Archetype>>& getArchetypes();
-        std::shared_ptr<Archetype> getArchetype(const Signature& sig) const;
 
+        // Batched add : every entity gets a copy of component, with one migration pass
+        // per source archetype instead of one per entity.
         template<typename T>
-        void addComponent(const EntityHandle& entity, const T& component) {
-
-            if (!m_EntityToSignature.count(entity)) {
-                m_EntityToSignature[entity] = Signature();
+        void addComponent(std::span<const EntityHandle> entities, const T& component) {
+            ComponentRegistry::registerComponent<T>();
+            const ComponentId cid = getComponentId<T>();
+
+            for (const EntityHandle& entity : entities) {
+                Archetype* src = getEntityArchetype(entity);
+                if (src->hasComponentType(cid))
+                    getComponent<T>(entity) = component;
             }
 
-            Signature oldSig = m_EntityToSignature[entity];
-            Signature newSig = oldSig;
-            ComponentId cid = getComponentId<T>();
-            newSig.set(cid);
-
-            if (oldSig != newSig) {
-                moveEntity(oldSig, newSig, entity);
+            for (const MigratedBlock& block : migrate(entities, cid, true)) {
+                for (size_t i = 0; i < block.count; i++)
+                    new (block.archetype->getComponentPtr(cid, block.firstRow + i)) T(component);
+                notifyAdded(*block.archetype, block.firstRow, block.count, Signature().set(cid));
             }
-            getOrCreateArchetype(newSig)->addComponent<T>(entity, component);
-            m_EntityToSignature[entity] = newSig;
         }
 
         template<typename T>
         bool removeComponent(const EntityHandle& entity) {
-            
-            if (!m_EntityToSignature.count(entity)) return false;
-            Signature oldSig = m_EntityToSignature[entity];
-            ComponentId cid = getComponentId<T>();
-            if (!oldSig.test(cid)) return false;
-            Signature newSig = oldSig;
-            newSig.reset(cid);
-
-            if (oldSig != newSig) {
-                const auto arch = this->getArchetype(oldSig);
-                if (arch) arch->removeComponent<T>(entity);
-                moveEntity(oldSig, newSig, entity);
-                m_EntityToSignature[entity] = newSig;
-                return true;
-            }
-            return false;
+            const EntityLocation* location = m_Locations.find(entity);
+            const ComponentId cid = getComponentId<T>();
+            if (!location || !location->archetype->hasComponentType(cid)) return false;
+
+            // the dropped component is destroyed together with the old row
+            Archetype* src = location->archetype;
+            Archetype* dst = getRemoveTarget(src, cid);
+            size_t row = location->row;
+            notifyRemoved(*src, { &row, 1 }, Signature().set(cid));
+            src->migrateRows(*dst, { &row, 1 });
+            return true;
+        }
+
+        template<typename T>
+        void removeComponent(std::span<const EntityHandle> entities) {
+            migrate(entities, getComponentId<T>(), false);
         }
 
+        // Mutable access, so the entity's chunk is marked changed for T.
         template<typename T>
         T& getComponent(const EntityHandle& entity) {
-            return this->getArchetype(m_EntityToSignature[entity])->getComponent<T>(entity);
+            const EntityLocation* location = m_Locations.find(entity);
+            LGT_ASSERT_MSG(location, "[ComponentManager::getComponent] Entity has no components.");
+            location->archetype->markRowChanged(getComponentId<T>(), location->row);
+            return *static_cast<T*>(location->archetype->getComponentPtr(getComponentId<T>(), location->row));
         }
 
         template<typename T>
         bool hasComponent(const EntityHandle& entity) {
-            if (!m_EntityToSignature.count(entity)) return false;
-            ComponentId cid = getComponentId<T>();
-            return m_EntityToSignature[entity].test(cid);
+            const EntityLocation* location = m_Locations.find(entity);
+            return location && location->archetype->hasComponentType(getComponentId<T>());
         }
     };
 
@@ -3,26 +3,46 @@
 
 namespace lgt {
 
-    std::unordered_map<ComponentId, ComponentRegistry::F_ForMoving>& ComponentRegistry::MoveFunc() {
-        static std::unordered_map<ComponentId, F_ForMoving> map;
-        return map;
+    std::vector<ComponentInfo>& ComponentRegistry::Infos() {
+        // sized once so registering from a worker never reallocates under a reader
+        static std::vector<ComponentInfo> infos(MAX_COMPONENTS);
+        return infos;
     }
 
-    std::unordered_map<ComponentId, ComponentRegistry::F_ForRemoving>& ComponentRegistry::RemoveFunc() {
-        static std::unordered_map<ComponentId, F_ForRemoving> map;
-        return map;
+    const ComponentInfo& ComponentRegistry::getInfo(ComponentId id) {
+        auto& infos = Infos();
+        LGT_ASSERT_MSG(id >= 0 && static_cast<size_t>(id) < infos.size() && infos[id].isValid(),
+            "[ComponentRegistry::getInfo] Component type was never registered.");
+        return infos[id];
     }
 
-    ComponentRegistry::F_ForMoving ComponentRegistry::getMovefunc(ComponentId id) {
-        auto& map = MoveFunc();
-        auto it = map.find(id);
-        return (it != map.end()) ? it->second : nullptr;
+    ComponentId ComponentRegistry::findByName(std::string_view name) {
+        for (const ComponentInfo& info : Infos()) {
+            if (info.isValid() && info.name && name == info.name)
+                return info.id;
+        }
+        return ComponentIdError;
     }
 
-    ComponentRegistry::F_ForRemoving ComponentRegistry::getRemovefunc(ComponentId id) {
-        auto& map = RemoveFunc();
-        auto it = map.find(id);
-        return (it != map.end()) ? it->second : nullptr;
+    void ComponentRegistry::setName(ComponentId id, const char* name) {
+        auto& infos = Infos();
+        LGT_ASSERT_MSG(id >= 0 && static_cast<size_t>(id) < infos.size(),
+            "[ComponentRegistry::setName] Component id out of range.");
+        infos[id].name = name;
+    }
+
+    void ComponentRegistry::setTransient(ComponentId id) {
+        auto& infos = Infos();
+        LGT_ASSERT_MSG(id >= 0 && static_cast<size_t>(id) < infos.size(),
+            "[ComponentRegistry::setTransient] Component id out of range.");
+        infos[id].transient = true;
+    }
+
+    void ComponentRegistry::registerInfo(const ComponentInfo& info) {
+        auto& infos = Infos();
+        LGT_ASSERT_MSG(info.id >= 0 && static_cast<size_t>(info.id) < infos.size(),
+            "[ComponentRegistry::registerInfo] Component id out of range.");
+        infos[info.id] = info;
     }
 
 } // namespace lgt
@@ -4,35 +4,64 @@
 #include "Core.h"
 
 #include <vector>
-#include <unordered_map>
-#include <memory>
-#include <functional>
+#include <new>
+#include <utility>
+#include <string_view>
+#include <type_traits>
 
 namespace lgt {
 
-    struct Archetype; // forward declaration
+    // Type-erased description of a component type, enough for an archetype
+    // to lay the type out inside a chunk and to move/destroy it without knowing T.
+    struct ComponentInfo {
+        ComponentId id    = ComponentIdError;
+        size_t      size  = 0;
+        size_t      align = 0;
+        void (*moveConstruct)(void* dst, void* src) = nullptr; // placement-move, src is left moved-from
+        void (*destroy)(void* ptr)                  = nullptr;
+        bool        trivial = false;   // trivially copyable : rows can be copied as raw bytes
+        const char* name    = nullptr; // set by LGT_REGISTER_COMPONENT, stable across runs
+        bool        transient = false; // only meaningful in this process, never saved (LGT_REGISTER_TRANSIENT_COMPONENT)
 
-    struct LGT_API ComponentRegistry {
-        using F_ForMoving = std::function<void(EntityHandle, const std::shared_ptr<Archetype>&, const std::shared_ptr<Archetype>&)>;
-        using F_ForRemoving = std::function<void(EntityHandle, const std::shared_ptr<Archetype>&)>;
+        bool isValid() const { return id != ComponentIdError; }
+    };
 
-        static std::unordered_map<ComponentId, F_ForMoving>& MoveFunc();
-        static std::unordered_map<ComponentId, F_ForRemoving>& RemoveFunc();
+    struct LGT_API ComponentRegistry {
+        static std::vector<ComponentInfo>& Infos();
 
+        // Records the layout/lifetime info of T. Cheap after the first call.
+        // A name lets the type be found again by findByName() (snapshots, tools).
         template<typename T>
-        static void registerMoveFunc(F_ForMoving func) {
-            ComponentId typid = getComponentId<T>();
-            MoveFunc()[typid] = std::move(func);
-            //LGT_CORE_INFO("Component Rigestered  | ComponentId : {}",typid);
+        static const ComponentInfo& registerComponent(const char* name = nullptr) {
+            static const bool registered = (registerInfo(makeInfo<T>()), true);
+            (void)registered;
+            if (name)
+                setName(getComponentId<T>(), name);
+            return getInfo(getComponentId<T>());
         }
 
+        // Keeps the type out of snapshots, e.g. components holding handles into run-time registries.
+        static void setTransient(ComponentId id);
+
+        static const ComponentInfo& getInfo(ComponentId id);
+        // ComponentIdError if no registered type has that name.
+        static ComponentId findByName(std::string_view name);
+
+    private:
+        static void registerInfo(const ComponentInfo& info);
+        static void setName(ComponentId id, const char* name);
+
         template<typename T>
-        static void registerRemoveFunc(F_ForRemoving func) {
-            RemoveFunc()[getComponentId<T>()] = std::move(func);
+        static ComponentInfo makeInfo() {
+            ComponentInfo info;
+            info.id    = getComponentId<T>();
+            info.size  = sizeof(T);
+            info.align = alignof(T);
+            info.moveConstruct = [](void* dst, void* src) { new (dst) T(std::move(*static_cast<T*>(src))); };
+            info.destroy       = [](void* ptr) { static_cast<T*>(ptr)->~T(); };
+            info.trivial       = std::is_trivially_copyable_v<T>;
+            return info;
         }
-
-        static F_ForMoving   getMovefunc(ComponentId id);
-        static F_ForRemoving getRemovefunc(ComponentId id);
     };
 
 } // namespace lgt
@@ -39,34 +39,35 @@
             }                                                                       \
         }
 #else
-#define lgt_ASSERT(expr) (void)0
-#define lgt_ASSERT_MSG(expr, msg, ...) (void)0
+#define LGT_ASSERT(expr) (void)0
+#define LGT_ASSERT_MSG(expr, msg, ...) (void)0
 #endif
 
 // ==================== Component Registration ====================
+// Registers the layout/lifetime info of a component type at static-init time so
+// archetypes can be built for it before the first addComponent<T>() call.
+// The type is also named "Namespace::ComponentType", which is how snapshots find it.
 #define LGT_REGISTER_COMPONENT(Namespace, ComponentType)                                \
 namespace Namespace {                                                               \
-    static void move##ComponentType(                                                \
-        EntityHandle e,                                                             \
-        const std::shared_ptr<Archetype>& oldArch,                                  \
-        const std::shared_ptr<Archetype>& newArch)                                  \
-    {                                                                               \
-        auto data = oldArch->getComponent<ComponentType>(e);                        \
-        newArch->addComponent<ComponentType>(e, data);                              \
-        oldArch->removeComponent<ComponentType>(e);                                 \
-    }                                                                               \
-                                                                                    \
-    static void remove##ComponentType(                                              \
-        EntityHandle e,                                                             \
-        const std::shared_ptr<Archetype>& arch)                                     \
-    {                                                                               \
-        arch->removeComponent<ComponentType>(e);                                    \
-    }                                                                               \
+    struct ComponentType##Registrar {                                               \
+        ComponentType##Registrar() {                                                \
+            ComponentRegistry::registerComponent<ComponentType>(                    \
+                #Namespace "::" #ComponentType);                                    \
+        }                                                                           \
+    };                                                                              \
                                                                                     \
+    static ComponentType##Registrar s_##ComponentType##Registrar;                   \
+}
+
+// Same, for components whose values only mean something in the running process
+// (handles into asset or GPU registries) : named for tools, but never saved by snapshots.
+#define LGT_REGISTER_TRANSIENT_COMPONENT(Namespace, ComponentType)                      \
+namespace Namespace {                                                               \
     struct ComponentType##Registrar {                                               \
         ComponentType##Registrar() {                                                \
-            ComponentRegistry::registerMoveFunc<ComponentType>(move##ComponentType);     \
-            ComponentRegistry::registerRemoveFunc<ComponentType>(remove##ComponentType); \
+            ComponentRegistry::registerComponent<ComponentType>(                    \
+                #Namespace "::" #ComponentType);                                    \
+            ComponentRegistry::setTransient(getComponentId<ComponentType>());       \
         }                                                                           \
     };                                                                              \
                                                                                     \
@@ -1,7 +1,8 @@
 #pragma once 
-#include<bitset>
 #include<memory>
+#include<cstdint>
 #include "UUID.h"
+#include "Signature.h"
 
 namespace lgt {
 	
@@ -17,11 +18,26 @@ namespace lgt {
 	struct Archetype;
 
 	// defines for ECS
-	using  EntityHandle = uint32_t;
+	// An entity handle packs its slot index (low 32 bits) and the slot generation
+	// (high 32 bits); destroying an entity bumps the generation so old handles go stale.
+	using  EntityHandle = uint64_t;
 	using  ComponentId = int;
-	const  size_t      MAX_ENTITIES = 50000;
-	const  ComponentId MAX_COMPONENTS = 32;
+	const  ComponentId MAX_COMPONENTS = static_cast<ComponentId>(Signature::BITS);
 	const  ComponentId ComponentIdError = static_cast<ComponentId>(-1);
-	using  Signature = std::bitset<MAX_COMPONENTS>;
+	// Change-detection clock, see ComponentManager::advanceTick(). 64 bits so plain
+	// comparisons never see it wrap (a 32-bit clock wraps after ~2^32 system runs).
+	using  Tick = uint64_t;
+	// Returned by Roster::onAdd / onRemove, see ComponentManager observers.
+	using  ObserverId = uint32_t;
+
+	const  EntityHandle NullEntity = ~EntityHandle(0);
+	// Never used by a live entity; marks CommandBuffer placeholder handles.
+	const  uint32_t     ReservedGeneration = UINT32_MAX;
+
+	constexpr uint32_t entityIndex(EntityHandle entity)      { return static_cast<uint32_t>(entity); }
+	constexpr uint32_t entityGeneration(EntityHandle entity) { return static_cast<uint32_t>(entity >> 32); }
+	constexpr EntityHandle makeEntityHandle(uint32_t index, uint32_t generation) {
+		return (static_cast<EntityHandle>(generation) << 32) | index;
+	}
 
 }
\ No newline at end of file
@@ -2,15 +2,18 @@
 #include "Defines.h"
 #include "ComponentManager.h"
 #include <vector>
-#include <queue>
+#include <unordered_map>
+#include <memory>
+#include <span>
 
 namespace lgt {
 
     class Roster;
+    class Snapshot;
 
     class Entity {
     public:
-        Entity(EntityHandle handle, Roster* registry, UUID id , std::string name);
+        Entity(EntityHandle handle, Roster* registry, std::string name);
 
         template<typename ComponentType, typename... Args>
         void addComponent(Args&&... args);
@@ -21,7 +24,11 @@ namespace lgt {
         template<typename ComponentType>
         ComponentType& getComponent();
 
-        UUID getUUID() const { return m_UUID; }
+        template<typename ComponentType>
+        bool hasComponent();
+
+        const UUID& getUUID() const;
+        bool isAlive() const;
         EntityHandle getHandle() const { return m_Handle; }
        
         const std::string& getName()const{
@@ -30,25 +37,47 @@ namespace lgt {
     private:
         std::string m_Name;
         EntityHandle m_Handle;
-        UUID m_UUID;  // unique ID for safety
         Roster* m_Registry;
     };
 
     //entity Roster
     class Roster {
     private:
-        std::queue<EntityHandle>  m_AvailHandles;
-        std::vector<UUID>         m_EntityIds;
-        ComponentManager          m_ComponenetManager;
+        static constexpr uint32_t NullIndex       = UINT32_MAX;
+        static constexpr size_t   SLOT_PAGE_SHIFT = 12;
+        static constexpr size_t   SLOT_PAGE_SIZE  = size_t(1) << SLOT_PAGE_SHIFT;
+
+        // One entry per entity index. A live slot holds the entity's handle; a free slot
+        // holds the next free index in its low bits and the generation to hand out next.
+        // Slots live in fixed pages allocated as indices are first used, so there is no
+        // startup cost, no cap and growing never moves existing slots.
+        std::vector<std::unique_ptr<EntityHandle[]>> m_SlotPages;
+        uint32_t                                     m_SlotCount = 0; // indices handed out so far
+        uint32_t                                     m_FreeHead = NullIndex;
+        ComponentManager                             m_ComponenetManager;
 
+        // UUID per entity index, for serialization. Paged like the slots, but a page is only
+        // allocated once an id in it is asked for or loaded. A null (0, 0) id is not assigned
+        // yet (a v4 UUID is never null); getUUID() generates it on first use.
+        struct IdSlot {
+            UUID id{ 0, 0 };
+        };
+        std::vector<std::unique_ptr<IdSlot[]>>       m_IdPages;
+
+        // Component changes through a stale handle are ignored : the index may already
+        // belong to another entity, whose location record they would overwrite.
         template<typename ComponentType, typename... Args>
         void addComponent(const EntityHandle& handle, Args&&... args) {
+            if (!isAlive(handle))
+                return;
             m_ComponenetManager.addComponent<ComponentType>(
                 handle, ComponentType{ std::forward<Args>(args)... });
         }
 
         template<typename ComponentType>
         bool removeComponent(const EntityHandle& handle) {
+            if (!isAlive(handle))
+                return false;
             return m_ComponenetManager.removeComponent<ComponentType>(handle);
         }
 
@@ -68,44 +97,167 @@ namespace lgt {
             m_ComponenetManager.removeAllComponents(handle);
         }
 
-    public:
-        Roster() {
-            for (EntityHandle e = 0; e < MAX_ENTITIES; e++) {
-                m_AvailHandles.push(e);
-                m_EntityIds.push_back(UUID()); // generate fresh UUIDs
+        EntityHandle& slot(uint32_t index) const {
+            return m_SlotPages[index >> SLOT_PAGE_SHIFT][index & (SLOT_PAGE_SIZE - 1)];
+        }
+
+        UUID& idSlot(uint32_t index) {
+            const size_t page = index >> SLOT_PAGE_SHIFT;
+            if (page >= m_IdPages.size())
+                m_IdPages.resize(page + 1);
+            if (!m_IdPages[page])
+                m_IdPages[page] = std::make_unique<IdSlot[]>(SLOT_PAGE_SIZE);
+            return m_IdPages[page][index & (SLOT_PAGE_SIZE - 1)].id;
+        }
+
+        EntityHandle allocateHandle() {
+            EntityHandle handle;
+            if (m_FreeHead != NullIndex) {
+                const uint32_t index = m_FreeHead;
+                const EntityHandle free = slot(index);
+                m_FreeHead = entityIndex(free);
+                handle = makeEntityHandle(index, entityGeneration(free));
             }
+            else {
+                LGT_ASSERT_MSG(m_SlotCount != NullIndex, "Entity Overflow");
+                const uint32_t index = m_SlotCount++;
+                if ((index >> SLOT_PAGE_SHIFT) >= m_SlotPages.size())
+                    m_SlotPages.push_back(std::make_unique<EntityHandle[]>(SLOT_PAGE_SIZE));
+                handle = makeEntityHandle(index, 0);
+            }
+            slot(entityIndex(handle)) = handle;
+            return handle;
         }
 
-        ~Roster() = default;
+        // Bumps the slot generation and pushes it on the free list.
+        void releaseHandle(const EntityHandle& handle) {
+            const uint32_t index = entityIndex(handle);
+            if ((index >> SLOT_PAGE_SHIFT) < m_IdPages.size() && m_IdPages[index >> SLOT_PAGE_SHIFT])
+                m_IdPages[index >> SLOT_PAGE_SHIFT][index & (SLOT_PAGE_SIZE - 1)].id = UUID(0, 0);
 
-        Entity createEntity(std::string name  = "NoName") {
+            const uint32_t generation = entityGeneration(handle) + 1;
+            slot(index) = makeEntityHandle(m_FreeHead, generation == ReservedGeneration ? 0 : generation);
+            m_FreeHead = index;
+        }
+
+    public:
+        Roster() = default;
 
-            LGT_ASSERT_MSG(!m_AvailHandles.empty(), "Entity Overflow");
-            EntityHandle handle = m_AvailHandles.front();
-            m_AvailHandles.pop();
+        ~Roster() = default;
 
-            UUID id;
-            m_EntityIds[handle] = id;
+        Entity createEntity(std::string name  = "NoName") {
+            return Entity(allocateHandle(), this, name);
+        }
 
-            return Entity(handle, this, id , name);
+        // Spawns count entities that each start with a copy of every prototype component,
+        // e.g. createEntities(100000, Renderable{ ... }). The target archetype reserves all
+        // its chunks once and the components are constructed column by column.
+        template<typename... ComponentTypes>
+        std::vector<EntityHandle> createEntities(size_t count, const ComponentTypes&... prototype) {
+            std::vector<EntityHandle> handles(count);
+            for (EntityHandle& handle : handles)
+                handle = allocateHandle();
+            if constexpr (sizeof...(ComponentTypes) > 0)
+                m_ComponenetManager.spawn<ComponentTypes...>(handles, prototype...);
+            return handles;
         }
 
+        // Destroying a stale handle does nothing, so it can't free the index twice.
         void destroyEntity(const EntityHandle& handle) {
+            if (!isAlive(handle))
+                return;
             removeAllComponents(handle);
-            m_EntityIds[handle] = UUID(); // reset UUID
-            m_AvailHandles.push(handle);
+            releaseHandle(handle);
+        }
+
+        // Destroys many entities with one row-removal pass per archetype.
+        void destroyEntities(std::span<const EntityHandle> handles) {
+            m_ComponenetManager.removeAllComponents(handles);
+            for (const EntityHandle& handle : handles) {
+                if (isAlive(handle))
+                    releaseHandle(handle);
+            }
+        }
+
+        bool isAlive(const EntityHandle& handle) const {
+            const uint32_t index = entityIndex(handle);
+            return index < m_SlotCount && slot(index) == handle;
+        }
+
+        // Stable id for save files and the editor, generated the first time it is asked for.
+        const UUID& getUUID(const EntityHandle& handle) {
+            LGT_ASSERT_MSG(isAlive(handle), "[Roster::getUUID] Entity is not alive.");
+            UUID& id = idSlot(entityIndex(handle));
+            if (id == UUID(0, 0))
+                id = UUID();
+            return id;
         }
 
         const std::shared_ptr<Archetype> getArchetype(const Signature& signature) const {
             return m_ComponenetManager.getArchetype(signature);
         }
 
+        // All entities that have every one of Ts, e.g. view<Renderable>().each([](Renderable& r){...})
+        template<typename... ComponentTypes>
+        View<ComponentTypes...> view(const Signature& excluded = Signature()) {
+            return m_ComponenetManager.view<ComponentTypes...>(excluded);
+        }
+
+        // Batched add/remove callbacks, see ComponentManager::onAdd() / onRemove().
+        template<typename ComponentType, typename Func>
+        ObserverId onAdd(Func&& fn) {
+            return m_ComponenetManager.onAdd<ComponentType>(std::forward<Func>(fn));
+        }
+
+        template<typename ComponentType, typename Func>
+        ObserverId onRemove(Func&& fn) {
+            return m_ComponenetManager.onRemove<ComponentType>(std::forward<Func>(fn));
+        }
+
+        void removeObserver(ObserverId id) {
+            m_ComponenetManager.removeObserver(id);
+        }
+
+        // ECS memory use, see ComponentManager::getMemoryStats(); indexBytes also counts
+        // the entity slot and UUID pages.
+        MemoryStats getMemoryStats() const {
+            MemoryStats stats = m_ComponenetManager.getMemoryStats();
+            stats.indexBytes += m_SlotPages.size() * SLOT_PAGE_SIZE * sizeof(EntityHandle);
+            for (const auto& page : m_IdPages)
+                stats.indexBytes += page ? SLOT_PAGE_SIZE * sizeof(IdSlot) : 0;
+            return stats;
+        }
+
+        // See ComponentManager::compact().
+        size_t compact() {
+            return m_ComponenetManager.compact();
+        }
+
+        // Change-detection clock, see ComponentManager::advanceTick().
+        Tick getTick() const { return m_ComponenetManager.getTick(); }
+        Tick advanceTick() { return m_ComponenetManager.advanceTick(); }
+
+        template<typename... ComponentTypes, typename Func>
+        void each(Func&& fn) {
+            view<ComponentTypes...>().each(std::forward<Func>(fn));
+        }
+
         friend class Entity;
+        friend class CommandBuffer;
+        friend class Snapshot;
     };
 
     // Entity method definitions
-    inline Entity::Entity(EntityHandle handle, Roster* registry, UUID id  , std::string name)
-        : m_Handle(handle), m_Registry(registry), m_UUID(id) ,m_Name(name) {
+    inline Entity::Entity(EntityHandle handle, Roster* registry, std::string name)
+        : m_Handle(handle), m_Registry(registry), m_Name(name) {
+    }
+
+    inline const UUID& Entity::getUUID() const {
+        return m_Registry->getUUID(m_Handle);
+    }
+
+    inline bool Entity::isAlive() const {
+        return m_Registry->isAlive(m_Handle);
     }
 
     template<typename ComponentType, typename... Args>
@@ -123,4 +275,9 @@ namespace lgt {
         return m_Registry->getComponent<ComponentType>(m_Handle);
     }
 
+    template<typename ComponentType>
+    bool Entity::hasComponent() {
+        return m_Registry->hasComponent<ComponentType>(m_Handle);
+    }
+
 } // namespace lgt
@@ -0,0 +1,66 @@
+#pragma once
+#include "Defines.h"
+#include "Core.h"
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+namespace lgt {
+
+    struct Archetype;
+
+    // Where an entity's components live : its archetype and the row inside it.
+    struct EntityLocation {
+        Archetype* archetype  = nullptr;
+        uint32_t   row        = 0;
+        uint32_t   generation = 0; // generation of the handle the record belongs to
+    };
+
+    // Global entity -> (archetype, row) table shared by every archetype of a
+    // ComponentManager. Keyed by entity index in fixed pages allocated the first time an
+    // index inside them is used, so a lookup is two array reads and no hashing.
+    // Archetypes keep it current whenever a row is appended or swap-removed, so
+    // membership checks, lookups and migrations never search an archetype.
+    class EntityLocations {
+    public:
+        static constexpr size_t PAGE_SHIFT = 12;
+        static constexpr size_t PAGE_SIZE  = size_t(1) << PAGE_SHIFT;
+        static constexpr size_t PAGE_MASK  = PAGE_SIZE - 1;
+
+        // Null when the entity has no row anywhere (or the handle is stale).
+        const EntityLocation* find(const EntityHandle& entity) const {
+            const size_t page = entityIndex(entity) >> PAGE_SHIFT;
+            if (page >= m_Pages.size() || !m_Pages[page])
+                return nullptr;
+            const EntityLocation& location = m_Pages[page][entityIndex(entity) & PAGE_MASK];
+            return (location.archetype && location.generation == entityGeneration(entity)) ? &location : nullptr;
+        }
+
+        void set(const EntityHandle& entity, Archetype* archetype, size_t row) {
+            const size_t page = entityIndex(entity) >> PAGE_SHIFT;
+            if (page >= m_Pages.size())
+                m_Pages.resize(page + 1);
+            if (!m_Pages[page])
+                m_Pages[page] = std::make_unique<EntityLocation[]>(PAGE_SIZE);
+            m_Pages[page][entityIndex(entity) & PAGE_MASK] = { archetype, static_cast<uint32_t>(row), entityGeneration(entity) };
+        }
+
+        void erase(const EntityHandle& entity) {
+            const size_t page = entityIndex(entity) >> PAGE_SHIFT;
+            if (page < m_Pages.size() && m_Pages[page])
+                m_Pages[page][entityIndex(entity) & PAGE_MASK].archetype = nullptr;
+        }
+
+        size_t getReservedBytes() const {
+            size_t pages = 0;
+            for (const auto& page : m_Pages)
+                pages += page ? 1 : 0;
+            return pages * PAGE_SIZE * sizeof(EntityLocation) + m_Pages.capacity() * sizeof(m_Pages[0]);
+        }
+
+    private:
+        std::vector<std::unique_ptr<EntityLocation[]>> m_Pages;
+    };
+
+} // namespace lgt
\ No newline at end of file
@@ -0,0 +1,325 @@
+#include "Hierarchy.h"
+#include "helpers/JobSystem.h"
+
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define LGT_HIERARCHY_SSE 1
+#endif
+
+namespace lgt {
+
+    Mat4 operator*(const Mat4& a, const Mat4& b)
+    {
+        Mat4 out;
+#ifdef LGT_HIERARCHY_SSE
+        // column j of the result is a's columns weighted by column j of b
+        const __m128 c0 = _mm_load_ps(a.m + 0);
+        const __m128 c1 = _mm_load_ps(a.m + 4);
+        const __m128 c2 = _mm_load_ps(a.m + 8);
+        const __m128 c3 = _mm_load_ps(a.m + 12);
+        for (int j = 0; j < 4; j++) {
+            const float* col = b.m + j * 4;
+            __m128 r = _mm_mul_ps(c0, _mm_set1_ps(col[0]));
+            r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_set1_ps(col[1])));
+            r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_set1_ps(col[2])));
+            r = _mm_add_ps(r, _mm_mul_ps(c3, _mm_set1_ps(col[3])));
+            _mm_store_ps(out.m + j * 4, r);
+        }
+#else
+        for (int j = 0; j < 4; j++) {
+            for (int i = 0; i < 4; i++) {
+                out.m[j * 4 + i] = a.m[i] * b.m[j * 4 + 0] + a.m[4 + i] * b.m[j * 4 + 1]
+                                 + a.m[8 + i] * b.m[j * 4 + 2] + a.m[12 + i] * b.m[j * 4 + 3];
+            }
+        }
+#endif
+        return out;
+    }
+
+    uint32_t TransformHierarchy::slotOf(EntityHandle entity) const
+    {
+        const uint32_t index = entityIndex(entity);
+        if (entity == NullEntity || index >= m_SlotOf.size())
+            return NoSlot;
+        const uint32_t slot = m_SlotOf[index];
+        return (slot != NoSlot && m_Entities[slot] == entity) ? slot : NoSlot;
+    }
+
+    bool TransformHierarchy::contains(EntityHandle entity) const {
+        return slotOf(entity) != NoSlot;
+    }
+
+    void TransformHierarchy::add(EntityHandle entity, EntityHandle parent, const Mat4& local)
+    {
+        LGT_ASSERT_MSG(!contains(entity), "[TransformHierarchy::add] Entity already in hierarchy.");
+        const uint32_t index = entityIndex(entity);
+        if (index >= m_SlotOf.size())
+            m_SlotOf.resize(index + 1, NoSlot);
+        m_SlotOf[index] = static_cast<uint32_t>(m_Entities.size());
+
+        m_Entities.push_back(entity);
+        m_ParentEntities.push_back(parent);
+        m_Parents.push_back(NoParent);
+        m_Local.push_back(local);
+        m_World.push_back(local);
+        m_Dirty.push_back(1);
+        m_NeedsRebuild = true;
+    }
+
+    void TransformHierarchy::remove(EntityHandle entity)
+    {
+        const uint32_t slot = slotOf(entity);
+        if (slot == NoSlot) return;
+
+        // swap-remove, the depth order is restored by the next rebuild()
+        const uint32_t last = static_cast<uint32_t>(m_Entities.size() - 1);
+        if (slot != last) {
+            m_Entities[slot]       = m_Entities[last];
+            m_ParentEntities[slot] = m_ParentEntities[last];
+            m_Local[slot]          = m_Local[last];
+            m_World[slot]          = m_World[last];
+            m_Dirty[slot]          = m_Dirty[last];
+            m_SlotOf[entityIndex(m_Entities[slot])] = slot;
+        }
+        m_SlotOf[entityIndex(entity)] = NoSlot;
+
+        m_Entities.pop_back();
+        m_ParentEntities.pop_back();
+        m_Parents.pop_back();
+        m_Local.pop_back();
+        m_World.pop_back();
+        m_Dirty.pop_back();
+        m_Changed.clear(); // its slots no longer hold what was recomputed
+        m_NeedsRebuild = true;
+    }
+
+    void TransformHierarchy::setParent(EntityHandle entity, EntityHandle parent)
+    {
+        const uint32_t slot = slotOf(entity);
+        LGT_ASSERT_MSG(slot != NoSlot, "[TransformHierarchy::setParent] Entity not in hierarchy.");
+        for (EntityHandle ancestor = parent; ancestor != NullEntity;) {
+            LGT_ASSERT_MSG(ancestor != entity, "[TransformHierarchy::setParent] Parent is a descendant of the entity.");
+            const uint32_t ancestorSlot = slotOf(ancestor);
+            ancestor = ancestorSlot != NoSlot ? m_ParentEntities[ancestorSlot] : NullEntity;
+        }
+
+        m_ParentEntities[slot] = parent;
+        m_Dirty[slot] = 1;
+        m_NeedsRebuild = true;
+    }
+
+    void TransformHierarchy::setLocal(EntityHandle entity, const Mat4& local)
+    {
+        const uint32_t slot = slotOf(entity);
+        LGT_ASSERT_MSG(slot != NoSlot, "[TransformHierarchy::setLocal] Entity not in hierarchy.");
+        m_Local[slot] = local;
+        // slots move on rebuild(), which collects the dirty ones itself
+        if (!m_Dirty[slot] && !m_NeedsRebuild)
+            m_DirtySlots.push_back(slot);
+        m_Dirty[slot] = 1;
+    }
+
+    EntityHandle TransformHierarchy::getParent(EntityHandle entity) const
+    {
+        const uint32_t slot = slotOf(entity);
+        return slot != NoSlot ? m_ParentEntities[slot] : NullEntity;
+    }
+
+    const Mat4& TransformHierarchy::getLocal(EntityHandle entity) const
+    {
+        const uint32_t slot = slotOf(entity);
+        LGT_ASSERT_MSG(slot != NoSlot, "[TransformHierarchy::getLocal] Entity not in hierarchy.");
+        return m_Local[slot];
+    }
+
+    const Mat4& TransformHierarchy::getWorld(EntityHandle entity) const
+    {
+        const uint32_t slot = slotOf(entity);
+        LGT_ASSERT_MSG(slot != NoSlot, "[TransformHierarchy::getWorld] Entity not in hierarchy.");
+        return m_World[slot];
+    }
+
+    // Breadth-first from the roots : depth sorted, siblings contiguous.
+    void TransformHierarchy::rebuild()
+    {
+        const uint32_t count = static_cast<uint32_t>(m_Entities.size());
+
+        // children of every slot as one flat list (CSR), roots collected on the side
+        std::vector<uint32_t> childBegin(count + 1, 0);
+        std::vector<uint32_t> parentSlot(count);
+        std::vector<uint32_t> order;
+        order.reserve(count);
+        for (uint32_t i = 0; i < count; i++) {
+            parentSlot[i] = slotOf(m_ParentEntities[i]);
+            if (parentSlot[i] == NoSlot) {
+                if (m_ParentEntities[i] != NullEntity) {
+                    m_ParentEntities[i] = NullEntity; // parent was removed, now a root
+                    m_Dirty[i] = 1;
+                }
+                order.push_back(i);
+            }
+            else {
+                childBegin[parentSlot[i] + 1]++;
+            }
+        }
+        for (uint32_t i = 0; i < count; i++)
+            childBegin[i + 1] += childBegin[i];
+        std::vector<uint32_t> children(childBegin[count]);
+        std::vector<uint32_t> fill(childBegin.begin(), childBegin.end() - 1);
+        for (uint32_t i = 0; i < count; i++) {
+            if (parentSlot[i] != NoSlot)
+                children[fill[parentSlot[i]]++] = i;
+        }
+
+        // BFS; depth only grows along the queue, so level starts are where it steps up
+        std::vector<uint32_t> newSlot(count);
+        std::vector<uint32_t> depth(count, 0);
+        m_LevelBegin.assign(1, 0);
+        m_FirstChild.resize(count + 1);
+        for (uint32_t head = 0; head < order.size(); head++) {
+            const uint32_t node = order[head];
+            newSlot[node] = head;
+            if (head > 0 && depth[node] != depth[order[head - 1]])
+                m_LevelBegin.push_back(head);
+            m_FirstChild[head] = static_cast<uint32_t>(order.size());
+            for (uint32_t c = childBegin[node]; c < childBegin[node + 1]; c++) {
+                depth[children[c]] = depth[node] + 1;
+                order.push_back(children[c]);
+            }
+        }
+        LGT_ASSERT_MSG(order.size() == count, "[TransformHierarchy::rebuild] Cycle in hierarchy.");
+        m_LevelBegin.push_back(count);
+        m_FirstChild[count] = count;
+
+        auto permute = [&order](auto& values) {
+            std::remove_reference_t<decltype(values)> sorted;
+            sorted.reserve(values.size());
+            for (const uint32_t slot : order)
+                sorted.push_back(values[slot]);
+            values = std::move(sorted);
+        };
+        permute(m_Entities);
+        permute(m_ParentEntities);
+        permute(m_Local);
+        permute(m_World);
+        permute(m_Dirty);
+
+        m_DirtySlots.clear();
+        for (uint32_t i = 0; i < count; i++) {
+            const uint32_t oldParent = parentSlot[order[i]];
+            m_Parents[i] = oldParent != NoSlot ? newSlot[oldParent] : NoParent;
+            m_SlotOf[entityIndex(m_Entities[i])] = i;
+            if (m_Dirty[i])
+                m_DirtySlots.push_back(i);
+        }
+        m_NeedsRebuild = false;
+    }
+
+    size_t TransformHierarchy::update()
+    {
+        return update(JobSystem::get());
+    }
+
+    size_t TransformHierarchy::update(JobSystem& jobs)
+    {
+        if (m_NeedsRebuild)
+            rebuild();
+
+        // slots are depth sorted, so sorted dirty slots come level by level
+        std::sort(m_DirtySlots.begin(), m_DirtySlots.end());
+        m_Changed.clear();
+        m_Level.clear();
+        size_t updated = 0;
+        size_t nextDirty = 0;
+        size_t level = 0;
+        while (!m_Level.empty() || nextDirty < m_DirtySlots.size()) {
+            // nothing coming from above : jump to the level of the next dirty node
+            if (m_Level.empty())
+                level = std::upper_bound(m_LevelBegin.begin(), m_LevelBegin.end(), m_DirtySlots[nextDirty]) - m_LevelBegin.begin() - 1;
+
+            // dirty nodes of this level join the subtrees coming from the level above
+            const size_t inherited = m_Level.size();
+            for (; nextDirty < m_DirtySlots.size() && m_DirtySlots[nextDirty] < m_LevelBegin[level + 1]; nextDirty++)
+                m_Level.push_back({ m_DirtySlots[nextDirty], m_DirtySlots[nextDirty] + 1 });
+            if (m_Level.size() != inherited) {
+                std::sort(m_Level.begin(), m_Level.end(), [](const Range& a, const Range& b) { return a.begin < b.begin; });
+                size_t merged = 0;
+                for (size_t r = 1; r < m_Level.size(); r++) {
+                    if (m_Level[r].begin <= m_Level[merged].end)
+                        m_Level[merged].end = std::max(m_Level[merged].end, m_Level[r].end);
+                    else
+                        m_Level[++merged] = m_Level[r];
+                }
+                m_Level.resize(merged + 1);
+            }
+
+            updated += computeLevel(jobs);
+
+            // the children of a run of nodes lie between the first children of its ends
+            m_Below.clear();
+            for (const Range& range : m_Level) {
+                if (!m_Changed.empty() && m_Changed.back().end == range.begin)
+                    m_Changed.back().end = range.end;
+                else
+                    m_Changed.push_back(range);
+
+                const Range children{ m_FirstChild[range.begin], m_FirstChild[range.end] };
+                if (children.begin == children.end)
+                    continue;
+                if (!m_Below.empty() && m_Below.back().end == children.begin)
+                    m_Below.back().end = children.end;
+                else
+                    m_Below.push_back(children);
+            }
+            std::swap(m_Level, m_Below);
+            level++;
+        }
+
+        for (const uint32_t slot : m_DirtySlots)
+            m_Dirty[slot] = 0;
+        m_DirtySlots.clear();
+        return updated;
+    }
+
+    size_t TransformHierarchy::computeLevel(JobSystem& jobs)
+    {
+        auto compute = [this](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                const uint32_t parent = m_Parents[i];
+                m_World[i] = parent != NoParent ? m_World[parent] * m_Local[i] : m_Local[i];
+            }
+        };
+
+        m_Offsets.clear();
+        size_t total = 0;
+        for (const Range& range : m_Level) {
+            m_Offsets.push_back(total);
+            total += range.end - range.begin;
+        }
+
+        // one moved subtree or a level of a deep chain is not worth a job
+        constexpr size_t GRAIN = 1024;
+        if (total < GRAIN) {
+            for (const Range& range : m_Level)
+                compute(range.begin, range.end);
+            return total;
+        }
+
+        // nodes of one level only read the level above; the ranges are split as one run
+        jobs.parallelFor(0, total, GRAIN, [&](size_t begin, size_t end) {
+            size_t r = std::upper_bound(m_Offsets.begin(), m_Offsets.end(), begin) - m_Offsets.begin() - 1;
+            for (; begin < end; r++) {
+                const size_t first = m_Level[r].begin + (begin - m_Offsets[r]);
+                const size_t count = std::min<size_t>(end - begin, m_Level[r].end - first);
+                compute(first, first + count);
+                begin += count;
+            }
+        });
+        return total;
+    }
+
+} // namespace lgt
\ No newline at end of file
@@ -0,0 +1,101 @@
+#pragma once
+#include "Defines.h"
+#include "Core.h"
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace lgt {
+
+    class JobSystem;
+
+    // Column-major 4x4 matrix, same memory layout as glm::mat4 (16 floats, column after column).
+    struct alignas(16) Mat4 {
+        float m[16] = {
+            1.0f, 0.0f, 0.0f, 0.0f,
+            0.0f, 1.0f, 0.0f, 0.0f,
+            0.0f, 0.0f, 1.0f, 0.0f,
+            0.0f, 0.0f, 0.0f, 1.0f,
+        };
+    };
+
+    // a * b, four columns of SSE multiply-adds when available.
+    Mat4 operator*(const Mat4& a, const Mat4& b);
+
+    // Parent/child transforms for a set of entities.
+    // Nodes are stored depth sorted (every level after the one above it, children of a
+    // parent next to each other) in flat arrays of local and world matrices, so update()
+    // walks the levels top-down. Only dirty nodes (setLocal / reparented) and the nodes
+    // below them are recomputed : in that order the children of a contiguous run of nodes
+    // are contiguous one level down, so a moved subtree is one slot range per level and
+    // update() never visits the untouched rest of a level. Levels with enough work are
+    // split across the job system.
+    class TransformHierarchy {
+    public:
+        static constexpr uint32_t NoParent = UINT32_MAX;
+
+        // Adds the entity under parent (NullEntity for a root).
+        void add(EntityHandle entity, EntityHandle parent = NullEntity, const Mat4& local = Mat4());
+        // Removes the entity; its children become roots.
+        void remove(EntityHandle entity);
+        void setParent(EntityHandle entity, EntityHandle parent);
+        void setLocal(EntityHandle entity, const Mat4& local);
+
+        bool contains(EntityHandle entity) const;
+        EntityHandle getParent(EntityHandle entity) const;
+        const Mat4& getLocal(EntityHandle entity) const;
+        // World matrix as of the last update().
+        const Mat4& getWorld(EntityHandle entity) const;
+
+        // Re-sorts the nodes if the structure changed, then propagates world matrices level
+        // by level. Returns the number of nodes recomputed.
+        size_t update(JobSystem& jobs);
+        size_t update();
+
+        // fn(entity, world) for every node recomputed by the last update() (none once a
+        // node was removed since).
+        template<typename Func>
+        void eachChanged(Func&& fn) const {
+            for (const Range& range : m_Changed) {
+                for (uint32_t i = range.begin; i < range.end; i++)
+                    fn(m_Entities[i], m_World[i]);
+            }
+        }
+
+        size_t size() const { return m_Entities.size(); }
+        size_t getDepthCount() const { return m_LevelBegin.empty() ? 0 : m_LevelBegin.size() - 1; }
+
+    private:
+        static constexpr uint32_t NoSlot = UINT32_MAX;
+
+        struct Range {
+            uint32_t begin;
+            uint32_t end;
+        };
+
+        // all indexed by slot, in depth order once rebuilt
+        std::vector<EntityHandle> m_Entities;
+        std::vector<EntityHandle> m_ParentEntities;
+        std::vector<uint32_t>     m_Parents;    // parent slot, NoParent for roots
+        std::vector<Mat4>         m_Local;
+        std::vector<Mat4>         m_World;
+        std::vector<uint8_t>      m_Dirty;      // local or parent link changed since the last update
+        std::vector<uint32_t>     m_DirtySlots; // the m_Dirty slots, filled again by rebuild()
+        std::vector<uint32_t>     m_FirstChild; // slot of a node's first child; its children end where
+                                                // the next slot's begin, m_FirstChild[size()] == size()
+        std::vector<uint32_t>     m_LevelBegin; // level d is [m_LevelBegin[d], m_LevelBegin[d + 1])
+        std::vector<Range>        m_Changed;    // slots recomputed by the last update
+        std::vector<Range>        m_Level;      // update() scratch : ranges to compute on this level,
+        std::vector<Range>        m_Below;      // their children on the next one,
+        std::vector<size_t>       m_Offsets;    // and the work offset of each range
+        std::vector<uint32_t>     m_SlotOf;     // entity index -> slot
+        bool                      m_NeedsRebuild = false;
+
+        uint32_t slotOf(EntityHandle entity) const;
+        void     rebuild();
+        // World matrices of every slot in m_Level, whose parents are final. Returns the count.
+        size_t   computeLevel(JobSystem& jobs);
+    };
+
+} // namespace lgt
\ No newline at end of file
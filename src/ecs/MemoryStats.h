@@ -0,0 +1,44 @@
+#pragma once
+#include "Defines.h"
+
+#include <vector>
+#include <cstddef>
+
+namespace lgt {
+
+    // Bytes held by one component column of an archetype.
+    struct ComponentMemoryStats {
+        ComponentId id;
+        const char* name;          // null unless registered with LGT_REGISTER_COMPONENT
+        size_t      bytesReserved; // the column in every allocated chunk
+        size_t      bytesUsed;     // live rows only
+    };
+
+    // Bytes held by one archetype : its chunks plus the row -> entity list and change ticks.
+    struct ArchetypeMemoryStats {
+        Signature signature;
+        size_t    entities      = 0;
+        size_t    chunks        = 0; // allocated, including the ones no row reaches anymore
+        size_t    chunkCapacity = 0; // rows per chunk
+        size_t    bytesReserved = 0;
+        size_t    bytesUsed     = 0;
+        std::vector<ComponentMemoryStats> components;
+
+        // Share of the allocated rows that hold an entity.
+        float occupancy() const { return chunks ? float(entities) / float(chunks * chunkCapacity) : 0.0f; }
+    };
+
+    struct MemoryStats {
+        size_t archetypes      = 0;
+        size_t emptyArchetypes = 0; // released by compact()
+        size_t entities        = 0;
+        size_t chunks          = 0;
+        size_t bytesReserved   = 0; // archetypes only
+        size_t bytesUsed       = 0;
+        size_t indexBytes      = 0; // entity slots and entity -> row table
+        std::vector<ArchetypeMemoryStats> perArchetype;
+
+        float occupancy() const { return bytesReserved ? float(bytesUsed) / float(bytesReserved) : 0.0f; }
+    };
+
+} // namespace lgt
\ No newline at end of file
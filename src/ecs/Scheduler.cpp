@@ -0,0 +1,92 @@
+#include "Scheduler.h"
+
+#include <algorithm>
+
+namespace lgt {
+
+    // class Scheduler
+
+    CommandBuffer& SystemContext::commands()
+    {
+        return scheduler.getCommandBuffer();
+    }
+
+    Scheduler::Scheduler(Roster& roster, JobSystem& jobs)
+        : m_Roster(roster), m_Jobs(jobs)
+    {
+        for (unsigned i = 0; i < m_Jobs.getThreadCount(); i++)
+            m_Commands.push_back(std::make_unique<CommandBuffer>());
+    }
+
+    Scheduler::SystemBuilder Scheduler::addSystem(std::string name)
+    {
+        System system;
+        system.name = std::move(name);
+        m_Systems.push_back(std::move(system));
+        m_GraphDirty = true;
+        return SystemBuilder(*this, m_Systems.size() - 1);
+    }
+
+    // A system waits on every earlier system it conflicts with. Edges already implied
+    // through another dependency are kept; they cost one counter check each.
+    void Scheduler::buildGraph()
+    {
+        m_Dependencies.assign(m_Systems.size(), {});
+        for (size_t i = 0; i < m_Systems.size(); i++) {
+            for (size_t j = 0; j < i; j++) {
+                if (m_Systems[i].conflictsWith(m_Systems[j]))
+                    m_Dependencies[i].push_back(j);
+            }
+        }
+        m_GraphDirty = false;
+    }
+
+    const std::vector<std::vector<size_t>>& Scheduler::getDependencies()
+    {
+        if (m_GraphDirty)
+            buildGraph();
+        return m_Dependencies;
+    }
+
+    // Every system becomes one job released by its dependencies' counters, so a
+    // system starts as soon as the ones it conflicts with are done.
+    void Scheduler::run(float deltaTime)
+    {
+        const auto& dependencies = getDependencies();
+
+        std::vector<JobCounter> done(m_Systems.size());
+        std::vector<JobCounter*> waitOn;
+
+        for (size_t i = 0; i < m_Systems.size(); i++) {
+            waitOn.clear();
+            for (size_t dependency : dependencies[i])
+                waitOn.push_back(&done[dependency]);
+
+            System& system = m_Systems[i];
+            m_Jobs.runAfter(waitOn, [this, &system, deltaTime]() {
+                // a fresh tick per run : everything written after this point is newer
+                // than the lastRunTick this system will see next frame
+                const Tick tick = m_Roster.advanceTick();
+                SystemContext ctx{ m_Roster, *this, deltaTime, system.lastRunTick };
+                if (system.run)
+                    system.run(ctx);
+                system.lastRunTick = tick;
+            }, &done[i]);
+        }
+        for (auto& counter : done)
+            m_Jobs.wait(counter);
+
+        flushCommands();
+        m_Roster.advanceTick(); // writes between frames must not share a system's tick
+    }
+
+    // The frame's sync point : every thread's commands are merged and applied in one batch.
+    void Scheduler::flushCommands()
+    {
+        CommandBuffer& merged = *m_Commands[0];
+        for (size_t i = 1; i < m_Commands.size(); i++)
+            merged.append(*m_Commands[i]);
+        merged.flush(m_Roster);
+    }
+
+} // namespace lgt
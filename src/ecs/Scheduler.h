@@ -0,0 +1,137 @@
+#pragma once
+#include "Defines.h"
+#include "ECS.h"
+#include "CommandBuffer.h"
+#include "helpers/JobSystem.h"
+
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <functional>
+#include <type_traits>
+
+namespace lgt {
+
+    class Scheduler;
+
+    struct SystemContext {
+        Roster&    roster;
+        Scheduler& scheduler;
+        float      deltaTime;
+        Tick       lastRunTick; // world tick when this system last ran, 0 on the first run
+
+        // Command buffer of the calling thread; structural changes recorded here are
+        // applied once every system of the frame has run.
+        CommandBuffer& commands();
+    };
+
+    // A unit of per-frame work plus the component types it reads and writes.
+    // Two systems conflict when one writes something the other reads or writes.
+    struct System {
+        std::string name;
+        Signature   reads;
+        Signature   writes;
+        std::function<void(SystemContext&)> run;
+        Tick        lastRunTick = 0;
+
+        bool conflictsWith(const System& other) const {
+            return (writes & (other.reads | other.writes)).any()
+                || (other.writes & reads).any();
+        }
+    };
+
+    // Runs registered systems once per frame on the engine job system. Systems are
+    // ordered by registration; a system only waits for earlier systems it conflicts
+    // with, everything else runs concurrently.
+    class Scheduler {
+    public:
+        class SystemBuilder {
+        public:
+            SystemBuilder(Scheduler& scheduler, size_t index) : m_Scheduler(scheduler), m_Index(index) {}
+
+            template<typename... Ts>
+            SystemBuilder& reads() {
+                (system().reads.set(getComponentId<std::remove_const_t<Ts>>()), ...);
+                m_Scheduler.m_GraphDirty = true;
+                return *this;
+            }
+
+            template<typename... Ts>
+            SystemBuilder& writes() {
+                (system().writes.set(getComponentId<std::remove_const_t<Ts>>()), ...);
+                m_Scheduler.m_GraphDirty = true;
+                return *this;
+            }
+
+            SystemBuilder& run(std::function<void(SystemContext&)> fn) {
+                system().run = std::move(fn);
+                return *this;
+            }
+
+            // Declares Ts (const T = read, T = write) and runs fn(Ts&...) over every
+            // matching entity, with the chunks split across the job system.
+            template<typename... Ts, typename Func>
+            SystemBuilder& each(Func fn) {
+                (declare<Ts>(), ...);
+                View<Ts...> view = m_Scheduler.m_Roster.template view<Ts...>(); // resolved here, on the main thread
+                system().run = [view, fn](SystemContext& ctx) {
+                    ctx.scheduler.parallelEach(view, fn);
+                };
+                return *this;
+            }
+
+        private:
+            Scheduler& m_Scheduler;
+            size_t     m_Index;
+
+            System& system() { return m_Scheduler.m_Systems[m_Index]; }
+
+            template<typename T>
+            void declare() {
+                if constexpr (std::is_const_v<T>) reads<T>();
+                else                              writes<T>();
+            }
+        };
+
+        explicit Scheduler(Roster& roster, JobSystem& jobs = JobSystem::get());
+
+        SystemBuilder addSystem(std::string name);
+        void run(float deltaTime);
+
+        // Splits the view's chunks across the workers and waits for all of them.
+        template<typename... Ts, typename Func>
+        void parallelEach(const View<Ts...>& view, Func fn) {
+            JobCounter counter;
+            for (Archetype* archetype : view.getArchetypes()) {
+                const size_t chunks = archetype->getChunkCount();
+                const size_t perJob = std::max<size_t>(1, chunks / m_Jobs.getThreadCount());
+                for (size_t begin = 0; begin < chunks; begin += perJob) {
+                    const size_t end = std::min(chunks, begin + perJob);
+                    m_Jobs.run([&view, archetype, begin, end, &fn]() {
+                        for (size_t chunk = begin; chunk < end; chunk++)
+                            view.eachInChunk(*archetype, chunk, fn);
+                    }, &counter);
+                }
+            }
+            m_Jobs.wait(counter);
+        }
+
+        const std::vector<System>& getSystems() const { return m_Systems; }
+        CommandBuffer& getCommandBuffer() { return *m_Commands[m_Jobs.getThreadIndex()]; }
+        // For each system, the earlier systems it has to wait for.
+        const std::vector<std::vector<size_t>>& getDependencies();
+        JobSystem& getJobSystem() { return m_Jobs; }
+
+    private:
+        Roster&                           m_Roster;
+        JobSystem&                        m_Jobs;
+        std::vector<System>               m_Systems;
+        std::vector<std::vector<size_t>>  m_Dependencies;
+        std::vector<Scope<CommandBuffer>> m_Commands; // one per job system thread
+        bool                              m_GraphDirty = true;
+
+        void buildGraph();
+        void flushCommands();
+    };
+
+} // namespace lgt
@@ -0,0 +1,97 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+// Number of component types (tags included) a signature can hold. Must be a multiple of 128.
+#ifndef LGT_MAX_COMPONENTS
+#define LGT_MAX_COMPONENTS 256
+#endif
+
+namespace lgt {
+
+    // Fixed-width component bit set, one bit per component id.
+    // Stored as 16-byte aligned 64-bit words so masks can be tested two words at a time
+    // with SSE2 (see SignatureIndex).
+    class Signature {
+    public:
+        static constexpr size_t BITS  = LGT_MAX_COMPONENTS;
+        static constexpr size_t WORDS = BITS / 64;
+        static_assert(BITS % 128 == 0, "LGT_MAX_COMPONENTS must be a multiple of 128");
+
+        Signature& set(size_t bit)   { m_Words[bit >> 6] |= bitOf(bit); return *this; }
+        Signature& reset(size_t bit) { m_Words[bit >> 6] &= ~bitOf(bit); return *this; }
+        Signature& reset()           { m_Words.fill(0); return *this; }
+        bool test(size_t bit) const  { return (m_Words[bit >> 6] & bitOf(bit)) != 0; }
+
+        bool any() const {
+            uint64_t acc = 0;
+            for (const uint64_t word : m_Words) acc |= word;
+            return acc != 0;
+        }
+        bool none() const { return !any(); }
+
+        size_t count() const {
+            size_t bits = 0;
+            for (const uint64_t word : m_Words) bits += std::popcount(word);
+            return bits;
+        }
+
+        // Every bit of other is set here.
+        bool contains(const Signature& other) const {
+            uint64_t missing = 0;
+            for (size_t i = 0; i < WORDS; i++) missing |= other.m_Words[i] & ~m_Words[i];
+            return missing == 0;
+        }
+
+        bool intersects(const Signature& other) const {
+            uint64_t shared = 0;
+            for (size_t i = 0; i < WORDS; i++) shared |= other.m_Words[i] & m_Words[i];
+            return shared != 0;
+        }
+
+        // Calls fn(bit) for every set bit, lowest first.
+        template<typename Func>
+        void forEach(Func&& fn) const {
+            for (size_t i = 0; i < WORDS; i++) {
+                for (uint64_t word = m_Words[i]; word; word &= word - 1)
+                    fn(i * 64 + std::countr_zero(word));
+            }
+        }
+
+        Signature& operator&=(const Signature& other) { for (size_t i = 0; i < WORDS; i++) m_Words[i] &= other.m_Words[i]; return *this; }
+        Signature& operator|=(const Signature& other) { for (size_t i = 0; i < WORDS; i++) m_Words[i] |= other.m_Words[i]; return *this; }
+        Signature& operator^=(const Signature& other) { for (size_t i = 0; i < WORDS; i++) m_Words[i] ^= other.m_Words[i]; return *this; }
+
+        friend Signature operator&(Signature a, const Signature& b) { return a &= b; }
+        friend Signature operator|(Signature a, const Signature& b) { return a |= b; }
+        friend Signature operator^(Signature a, const Signature& b) { return a ^= b; }
+
+        bool operator==(const Signature& other) const { return m_Words == other.m_Words; }
+        bool operator!=(const Signature& other) const { return !(*this == other); }
+
+        const uint64_t* words() const { return m_Words.data(); }
+
+        size_t hash() const {
+            uint64_t h = 0xcbf29ce484222325ull;
+            for (const uint64_t word : m_Words)
+                h = (h ^ word) * 0x100000001b3ull;
+            return static_cast<size_t>(h ^ (h >> 32));
+        }
+
+    private:
+        alignas(16) std::array<uint64_t, WORDS> m_Words{};
+
+        static constexpr uint64_t bitOf(size_t bit) { return uint64_t(1) << (bit & 63); }
+    };
+
+} // namespace lgt
+
+namespace std {
+    template<>
+    struct hash<lgt::Signature> {
+        size_t operator()(const lgt::Signature& signature) const noexcept { return signature.hash(); }
+    };
+}
@@ -0,0 +1,72 @@
+#include "SignatureIndex.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LGT_SIGNATURE_SSE2 1
+#endif
+
+namespace lgt {
+
+    void SignatureIndex::add(const Signature& signature, Archetype* archetype)
+    {
+        m_Signatures.push_back(signature);
+        m_Archetypes.push_back(archetype);
+    }
+
+    void SignatureIndex::remove(Archetype* archetype)
+    {
+        for (size_t i = 0; i < m_Archetypes.size(); i++) {
+            if (m_Archetypes[i] != archetype) continue;
+            m_Signatures[i] = m_Signatures.back();
+            m_Archetypes[i] = m_Archetypes.back();
+            m_Signatures.pop_back();
+            m_Archetypes.pop_back();
+            return;
+        }
+    }
+
+    void SignatureIndex::clear()
+    {
+        m_Signatures.clear();
+        m_Archetypes.clear();
+    }
+
+#ifdef LGT_SIGNATURE_SSE2
+
+    // (sig & include) ^ include and sig & exclude, OR-ed over the whole mask: zero means a match.
+    static inline bool matchesSse2(const Signature& signature, const Signature& include, const Signature& exclude)
+    {
+        const __m128i* sig = reinterpret_cast<const __m128i*>(signature.words());
+        const __m128i* inc = reinterpret_cast<const __m128i*>(include.words());
+        const __m128i* exc = reinterpret_cast<const __m128i*>(exclude.words());
+
+        __m128i acc = _mm_setzero_si128();
+        for (size_t i = 0; i < Signature::WORDS / 2; i++) {
+            const __m128i s = _mm_load_si128(sig + i);
+            const __m128i in = _mm_load_si128(inc + i);
+            acc = _mm_or_si128(acc, _mm_andnot_si128(s, in));
+            acc = _mm_or_si128(acc, _mm_and_si128(s, _mm_load_si128(exc + i)));
+        }
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(acc, _mm_setzero_si128())) == 0xFFFF;
+    }
+
+#endif
+
+    bool SignatureIndex::matches(const Signature& signature, const Signature& include, const Signature& exclude)
+    {
+#ifdef LGT_SIGNATURE_SSE2
+        return matchesSse2(signature, include, exclude);
+#else
+        return signature.contains(include) && !signature.intersects(exclude);
+#endif
+    }
+
+    void SignatureIndex::match(const Signature& include, const Signature& exclude, std::vector<Archetype*>& out) const
+    {
+        for (size_t i = 0; i < m_Signatures.size(); i++) {
+            if (matches(m_Signatures[i], include, exclude))
+                out.push_back(m_Archetypes[i]);
+        }
+    }
+
+} // namespace lgt
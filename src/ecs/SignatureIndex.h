@@ -0,0 +1,30 @@
+#pragma once
+#include "Defines.h"
+
+#include <vector>
+
+namespace lgt {
+
+    // Flat list of archetype signatures for query matching.
+    // Signatures sit back to back so a query is one linear SIMD sweep:
+    // an archetype matches when it has every include bit and no exclude bit.
+    class SignatureIndex {
+    public:
+        void add(const Signature& signature, Archetype* archetype);
+        // Swap-removes the archetype (ComponentManager::compact()).
+        void remove(Archetype* archetype);
+        void clear();
+
+        // Appends every archetype matching the query to out.
+        void match(const Signature& include, const Signature& exclude, std::vector<Archetype*>& out) const;
+
+        static bool matches(const Signature& signature, const Signature& include, const Signature& exclude);
+
+        size_t size() const { return m_Archetypes.size(); }
+
+    private:
+        std::vector<Signature>  m_Signatures;
+        std::vector<Archetype*> m_Archetypes;
+    };
+
+} // namespace lgt
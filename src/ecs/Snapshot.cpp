@@ -0,0 +1,356 @@
+#include "Snapshot.h"
+#include "ECS.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace lgt {
+
+    namespace {
+
+        constexpr char   MAGIC[4]   = { 'L', 'G', 'T', 'S' };
+        constexpr size_t BLOB_ALIGN = 64;
+
+        struct FileHeader {
+            char     magic[4];
+            uint32_t version;
+            uint32_t componentCount;
+            uint32_t archetypeCount;
+            uint64_t entityCount;
+        };
+
+        // followed by nameLength bytes of name, then padding to 8
+        struct ComponentRecord {
+            uint32_t size;
+            uint32_t align;
+            uint32_t nameLength;
+            uint32_t reserved;
+        };
+
+        // followed by columnCount schema indices, padding to BLOB_ALIGN, the UUID blob and
+        // one blob per column, each padded to BLOB_ALIGN
+        struct ArchetypeRecord {
+            uint64_t rowCount;
+            uint32_t columnCount;
+            uint32_t reserved;
+        };
+
+        struct UUIDRecord {
+            uint64_t high;
+            uint64_t low;
+        };
+
+        size_t alignUp(size_t value, size_t align) {
+            return (value + align - 1) & ~(align - 1);
+        }
+
+        // Read-only mapping of a whole file; data() is null if it could not be mapped.
+        class MappedFile {
+        public:
+            explicit MappedFile(const std::string& path) {
+#ifdef _WIN32
+                m_File = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+                if (m_File == INVALID_HANDLE_VALUE) return;
+                LARGE_INTEGER size;
+                if (!GetFileSizeEx(m_File, &size) || size.QuadPart == 0) return;
+                m_Mapping = CreateFileMappingA(m_File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                if (!m_Mapping) return;
+                m_Data = static_cast<const std::byte*>(MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0));
+                m_Size = m_Data ? static_cast<size_t>(size.QuadPart) : 0;
+#else
+                const int fd = open(path.c_str(), O_RDONLY);
+                if (fd < 0) return;
+                struct stat info;
+                if (fstat(fd, &info) == 0 && info.st_size > 0) {
+                    void* data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+                    if (data != MAP_FAILED) {
+                        m_Data = static_cast<const std::byte*>(data);
+                        m_Size = static_cast<size_t>(info.st_size);
+                    }
+                }
+                close(fd);
+#endif
+            }
+
+            ~MappedFile() {
+#ifdef _WIN32
+                if (m_Data) UnmapViewOfFile(m_Data);
+                if (m_Mapping) CloseHandle(m_Mapping);
+                if (m_File != INVALID_HANDLE_VALUE) CloseHandle(m_File);
+#else
+                if (m_Data) munmap(const_cast<std::byte*>(m_Data), m_Size);
+#endif
+            }
+
+            MappedFile(const MappedFile&) = delete;
+            MappedFile& operator=(const MappedFile&) = delete;
+
+            const std::byte* data() const { return m_Data; }
+            size_t size() const { return m_Size; }
+
+        private:
+            const std::byte* m_Data = nullptr;
+            size_t           m_Size = 0;
+#ifdef _WIN32
+            HANDLE m_File    = INVALID_HANDLE_VALUE;
+            HANDLE m_Mapping = nullptr;
+#endif
+        };
+
+        // Bounds-checked cursor over the mapped bytes; returns null once past the end.
+        // Counts come straight from the file, so sizes are never multiplied unchecked.
+        class Reader {
+        public:
+            Reader(const std::byte* data, size_t size) : m_Data(data), m_Size(size) {}
+
+            size_t remaining() const { return m_Size - m_Offset; }
+
+            const std::byte* bytes(size_t count) {
+                if (count > remaining()) return nullptr;
+                const std::byte* at = m_Data + m_Offset;
+                m_Offset += count;
+                return at;
+            }
+
+            // count elements of size bytes each; null when count * size is past the end
+            const std::byte* bytes(size_t count, size_t size) {
+                if (size != 0 && count > remaining() / size) return nullptr;
+                return bytes(count * size);
+            }
+
+            template<typename T>
+            const T* read(size_t count = 1) {
+                return reinterpret_cast<const T*>(bytes(count, sizeof(T)));
+            }
+
+            bool pad(size_t align) {
+                const size_t next = alignUp(m_Offset, align);
+                if (next > m_Size) return false;
+                m_Offset = next;
+                return true;
+            }
+
+        private:
+            const std::byte* m_Data;
+            size_t           m_Size;
+            size_t           m_Offset = 0;
+        };
+
+        class Writer {
+        public:
+            explicit Writer(std::ofstream& out) : m_Out(out) {}
+
+            void write(const void* data, size_t size) {
+                m_Out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+                m_Offset += size;
+            }
+
+            template<typename T>
+            void write(const T& value) { write(&value, sizeof(T)); }
+
+            void pad(size_t align) {
+                static const char zeros[BLOB_ALIGN] = {};
+                write(zeros, alignUp(m_Offset, align) - m_Offset);
+            }
+
+        private:
+            std::ofstream& m_Out;
+            size_t         m_Offset = 0;
+        };
+
+        // One archetype record of a mapped file, resolved against this run's registry.
+        struct ArchetypeBlock {
+            size_t                        rowCount;
+            const UUIDRecord*             ids;
+            std::vector<ComponentId>      columns; // ComponentIdError for skipped columns
+            std::vector<const std::byte*> blobs;
+        };
+
+    } // namespace
+
+    bool Snapshot::save(Roster& roster, const std::string& path)
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+
+        std::vector<Archetype*> archetypes;
+        std::vector<int> schemaIndex(MAX_COMPONENTS, -1);
+        std::vector<ComponentId> schema;
+        uint64_t entityCount = 0;
+        for (auto& [signature, archetype] : roster.m_ComponenetManager.getArchetypes()) {
+            if (archetype->getSize() == 0) continue;
+            archetypes.push_back(archetype.get());
+            entityCount += archetype->getSize();
+            for (const Archetype::Column& column : archetype->getColumns()) {
+                if (column.info.trivial && column.info.name && !column.info.transient && schemaIndex[column.info.id] < 0) {
+                    schemaIndex[column.info.id] = static_cast<int>(schema.size());
+                    schema.push_back(column.info.id);
+                }
+            }
+        }
+
+        Writer writer(out);
+        FileHeader header{};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.componentCount = static_cast<uint32_t>(schema.size());
+        header.archetypeCount = static_cast<uint32_t>(archetypes.size());
+        header.entityCount = entityCount;
+        writer.write(header);
+
+        for (const ComponentId id : schema) {
+            const ComponentInfo& info = ComponentRegistry::getInfo(id);
+            const uint32_t nameLength = static_cast<uint32_t>(std::strlen(info.name));
+            writer.write(ComponentRecord{ static_cast<uint32_t>(info.size), static_cast<uint32_t>(info.align), nameLength, 0 });
+            writer.write(info.name, nameLength);
+            writer.pad(8);
+        }
+
+        std::vector<UUIDRecord> ids;
+        for (Archetype* archetype : archetypes) {
+            std::vector<const Archetype::Column*> columns;
+            for (const Archetype::Column& column : archetype->getColumns()) {
+                if (schemaIndex[column.info.id] >= 0)
+                    columns.push_back(&column);
+            }
+
+            writer.write(ArchetypeRecord{ archetype->getSize(), static_cast<uint32_t>(columns.size()), 0 });
+            for (const Archetype::Column* column : columns)
+                writer.write(static_cast<uint32_t>(schemaIndex[column->info.id]));
+            writer.pad(BLOB_ALIGN);
+
+            ids.clear();
+            for (const EntityHandle& entity : archetype->getEntities()) {
+                const UUID& id = roster.getUUID(entity);
+                ids.push_back({ id.getHigh(), id.getLow() });
+            }
+            writer.write(ids.data(), ids.size() * sizeof(UUIDRecord));
+            writer.pad(BLOB_ALIGN);
+
+            // rows are contiguous per chunk, so a column is written one chunk at a time
+            for (const Archetype::Column* column : columns) {
+                for (size_t chunk = 0; chunk < archetype->getChunkCount(); chunk++) {
+                    const size_t firstRow = chunk * archetype->getChunkCapacity();
+                    writer.write(archetype->getComponentPtr(column->info.id, firstRow),
+                        archetype->getChunkSize(chunk) * column->info.size);
+                }
+                writer.pad(BLOB_ALIGN);
+            }
+        }
+        return static_cast<bool>(out);
+    }
+
+    bool Snapshot::load(Roster& roster, const std::string& path, std::vector<EntityHandle>* created)
+    {
+        MappedFile file(path);
+        if (!file.data()) return false;
+
+        // parse and bounds-check the whole file before the roster is touched
+        Reader reader(file.data(), file.size());
+        const FileHeader* header = reader.read<FileHeader>();
+        if (!header || std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 || header->version != VERSION)
+            return false;
+        // every record takes file bytes, so larger counts are corrupt; checked before they size anything
+        if (header->componentCount > reader.remaining() / sizeof(ComponentRecord)
+            || header->archetypeCount > reader.remaining() / sizeof(ArchetypeRecord))
+            return false;
+
+        std::vector<ComponentId> schema(header->componentCount, ComponentIdError);
+        std::vector<size_t> schemaSize(header->componentCount, 0);
+        for (uint32_t i = 0; i < header->componentCount; i++) {
+            const ComponentRecord* record = reader.read<ComponentRecord>();
+            const char* name = record ? reader.read<char>(record->nameLength) : nullptr;
+            if (!name || !reader.pad(8)) return false;
+
+            schemaSize[i] = record->size;
+            const ComponentId id = ComponentRegistry::findByName(std::string_view(name, record->nameLength));
+            if (id == ComponentIdError) continue;
+            const ComponentInfo& info = ComponentRegistry::getInfo(id);
+            if (info.trivial && !info.transient && info.size == record->size && info.align == record->align)
+                schema[i] = id;
+        }
+
+        std::vector<ArchetypeBlock> blocks(header->archetypeCount);
+        size_t entityCount = 0;
+        for (ArchetypeBlock& block : blocks) {
+            const ArchetypeRecord* record = reader.read<ArchetypeRecord>();
+            const uint32_t* columns = record ? reader.read<uint32_t>(record->columnCount) : nullptr;
+            if (!columns || !reader.pad(BLOB_ALIGN)) return false;
+
+            // each row has at least its UUID in the file
+            if (record->rowCount > reader.remaining() / sizeof(UUIDRecord)) return false;
+            block.rowCount = static_cast<size_t>(record->rowCount);
+            block.ids = reader.read<UUIDRecord>(block.rowCount);
+            if (!block.ids || !reader.pad(BLOB_ALIGN)) return false;
+
+            Signature signature;
+            for (uint32_t c = 0; c < record->columnCount; c++) {
+                if (columns[c] >= schema.size()) return false;
+                const std::byte* blob = reader.bytes(block.rowCount, schemaSize[columns[c]]);
+                if (!blob || !reader.pad(BLOB_ALIGN)) return false;
+
+                const ComponentId id = schema[columns[c]];
+                const bool keep = id != ComponentIdError && !signature.test(id);
+                if (keep) signature.set(id);
+                block.columns.push_back(keep ? id : ComponentIdError);
+                block.blobs.push_back(blob);
+            }
+            entityCount += block.rowCount;
+        }
+
+        if (created) created->reserve(created->size() + entityCount);
+
+        std::vector<EntityHandle> handles;
+        for (const ArchetypeBlock& block : blocks) {
+            Signature signature;
+            for (const ComponentId id : block.columns) {
+                if (id != ComponentIdError) signature.set(id);
+            }
+
+            handles.resize(block.rowCount);
+            for (EntityHandle& handle : handles)
+                handle = roster.allocateHandle();
+
+            size_t firstRow = 0;
+            Archetype* dst = roster.m_ComponenetManager.placeEntities(signature, handles, firstRow);
+            const size_t capacity = dst->getChunkCapacity();
+            for (size_t c = 0; c < block.columns.size(); c++) {
+                const ComponentId id = block.columns[c];
+                if (id == ComponentIdError) continue;
+
+                // the blob is one contiguous column, the destination is split in chunks
+                const size_t size = ComponentRegistry::getInfo(id).size;
+                for (size_t row = 0; row < block.rowCount;) {
+                    const size_t dstRow = firstRow + row;
+                    const size_t count = std::min(capacity - dstRow % capacity, block.rowCount - row);
+                    std::memcpy(dst->getComponentPtr(id, dstRow), block.blobs[c] + row * size, count * size);
+                    row += count;
+                }
+            }
+            roster.m_ComponenetManager.notifyAdded(*dst, firstRow, block.rowCount, signature);
+
+            // straight into the id pages, no per-entity node
+            for (size_t row = 0; row < block.rowCount; row++)
+                roster.idSlot(entityIndex(handles[row])) = UUID(block.ids[row].high, block.ids[row].low);
+            if (created) created->insert(created->end(), handles.begin(), handles.end());
+        }
+        return true;
+    }
+
+} // namespace lgt
\ No newline at end of file
@@ -0,0 +1,34 @@
+#pragma once
+#include "Defines.h"
+
+#include <string>
+#include <vector>
+
+namespace lgt {
+
+    class Roster;
+
+    // Binary save/load of a Roster's entities.
+    //
+    // The file is a small schema (component name, size, align) followed by one record per
+    // archetype : its row count, the schema index of each column, then the entities'
+    // UUIDs and every column as raw, 64-byte aligned blobs. Loading maps the file and
+    // bulk-copies each blob into the chunks of the matching archetype, chunk by chunk,
+    // so there is no per-entity addComponent().
+    //
+    // Only components registered with LGT_REGISTER_COMPONENT (they need a stable name)
+    // and trivially copyable are written; other columns, and transient components
+    // (LGT_REGISTER_TRANSIENT_COMPONENT), are left out of the file. On load, a column
+    // whose name is unknown, whose size/align changed or that is now transient is skipped.
+    class Snapshot {
+    public:
+        static constexpr uint32_t VERSION = 1;
+
+        static bool save(Roster& roster, const std::string& path);
+        // Adds the snapshot's entities to roster (existing entities are kept) and, if
+        // created is given, appends their handles to it. Returns false, without touching
+        // roster, when the file is missing, truncated, corrupt or not a snapshot.
+        static bool load(Roster& roster, const std::string& path, std::vector<EntityHandle>* created = nullptr);
+    };
+
+} // namespace lgt
\ No newline at end of file
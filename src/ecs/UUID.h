@@ -1,33 +1,50 @@
-
 #pragma once
-#include <array>
 #include <random>
 #include <string>
-#include <sstream>
-#include <iomanip>
 #include <cstdint>
-#include <algorithm>
+#include <cstddef>
+#include <functional>
 
 #include "Core.h"
 
 namespace lgt
 {
+    // 128-bit RFC 4122 v4 id held as two words. Copies, compares and hashes are plain
+    // integer ops; the text form is only built when str() is called.
     class LGT_API UUID
     {
     public:
         UUID() { generate(); }
-        explicit UUID(const std::string& str) : value(str) {}
+        UUID(uint64_t high, uint64_t low) : m_High(high), m_Low(low) {}
+        // Parses the "xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx" form; dashes are optional.
+        explicit UUID(const std::string& str) { parse(str); }
+
+        uint64_t getHigh() const { return m_High; }
+        uint64_t getLow()  const { return m_Low; }
 
         // Returns string representation
-        const std::string& str() const { return value; }
+        std::string str() const
+        {
+            static constexpr char digits[] = "0123456789abcdef";
+            std::string out(36, '-');
+            size_t pos = 0;
+            for (int i = 0; i < 32; i++) {
+                if (i == 8 || i == 12 || i == 16 || i == 20) pos++;
+                const uint64_t word = i < 16 ? m_High : m_Low;
+                const int shift = 60 - (i % 16) * 4;
+                out[pos++] = digits[(word >> shift) & 0xF];
+            }
+            return out;
+        }
 
         // Operators
-        bool operator==(const UUID& other) const { return value == other.value; }
+        bool operator==(const UUID& other) const { return ((m_High ^ other.m_High) | (m_Low ^ other.m_Low)) == 0; }
         bool operator!=(const UUID& other) const { return !(*this == other); }
-        bool operator<(const UUID& other) const { return value < other.value; }
+        bool operator<(const UUID& other) const { return m_High != other.m_High ? m_High < other.m_High : m_Low < other.m_Low; }
 
     private:
-        std::string value;
+        alignas(16) uint64_t m_High = 0;
+        uint64_t m_Low = 0;
 
         void generate()
         {
@@ -35,25 +52,44 @@ namespace lgt
             static thread_local std::mt19937_64 gen(rd());
             static thread_local std::uniform_int_distribution<uint64_t> dis;
 
-            std::array<uint8_t, 16> bytes;
-            uint64_t p1 = dis(gen);
-            uint64_t p2 = dis(gen);
-
-            for (int i = 0; i < 8; i++) bytes[i] = static_cast<uint8_t>((p1 >> (i * 8)) & 0xFF);
-            for (int i = 0; i < 8; i++) bytes[i + 8] = static_cast<uint8_t>((p2 >> (i * 8)) & 0xFF);
+            m_High = dis(gen);
+            m_Low = dis(gen);
 
             // Apply RFC 4122 variant and version
-            bytes[6] = (bytes[6] & 0x0F) | 0x40; // Version 4 (random)
-            bytes[8] = (bytes[8] & 0x3F) | 0x80; // Variant 1 (RFC)
-
-            // Convert to string
-            std::ostringstream ss;
-            ss << std::hex << std::setfill('0');
-            for (size_t i = 0; i < bytes.size(); ++i) {
-                ss << std::setw(2) << static_cast<int>(bytes[i]);
-                if (i == 3 || i == 5 || i == 7 || i == 9) ss << "-";
+            m_High = (m_High & ~0xF000ull) | 0x4000ull;                           // Version 4 (random)
+            m_Low = (m_Low & ~0xC000000000000000ull) | 0x8000000000000000ull;  // Variant 1 (RFC)
+        }
+
+        void parse(const std::string& str)
+        {
+            int nibbles = 0;
+            for (const char c : str) {
+                uint64_t value;
+                if (c >= '0' && c <= '9')      value = c - '0';
+                else if (c >= 'a' && c <= 'f') value = c - 'a' + 10;
+                else if (c >= 'A' && c <= 'F') value = c - 'A' + 10;
+                else continue;
+
+                if (nibbles >= 32) break;
+                uint64_t& word = nibbles < 16 ? m_High : m_Low;
+                word = (word << 4) | value;
+                nibbles++;
             }
-            value = ss.str();
+            LGT_ASSERT_MSG(nibbles == 32, "[UUID::parse] Expected 32 hex digits.");
+        }
+    };
+}
+
+namespace std
+{
+    template<>
+    struct hash<lgt::UUID>
+    {
+        size_t operator()(const lgt::UUID& id) const noexcept
+        {
+            // both halves are already random, mixing them is enough
+            const uint64_t h = id.getHigh() ^ (id.getLow() * 0x9E3779B97F4A7C15ull);
+            return static_cast<size_t>(h ^ (h >> 32));
         }
     };
 }
@@ -0,0 +1,116 @@
+#pragma once
+#include "Defines.h"
+#include "Archetype.h"
+
+#include <vector>
+#include <tuple>
+#include <type_traits>
+
+namespace lgt {
+
+    // Iterates every entity that has all of Ts (a const T is a read-only column).
+    // The archetype list comes from the ComponentManager query cache, so building a
+    // view is one lookup and each() walks component columns chunk by chunk with no
+    // per-entity lookups. Visiting a chunk marks its non-const columns changed.
+    template<typename... Ts>
+    class View {
+    public:
+        explicit View(const std::vector<Archetype*>& archetypes) : m_Archetypes(&archetypes) {}
+
+        // Only visit chunks whose T column was written / had T added after since,
+        // e.g. view<Transform>().changed<Transform>(ctx.lastRunTick).
+        template<typename T>
+        View changed(Tick since) const {
+            View filtered = *this;
+            filtered.m_Filters.push_back({ getComponentId<std::remove_const_t<T>>(), since, false });
+            return filtered;
+        }
+
+        template<typename T>
+        View added(Tick since) const {
+            View filtered = *this;
+            filtered.m_Filters.push_back({ getComponentId<std::remove_const_t<T>>(), since, true });
+            return filtered;
+        }
+
+        // fn(Ts&...) or fn(EntityHandle, Ts&...)
+        template<typename Func>
+        void each(Func&& fn) const {
+            for (Archetype* archetype : *m_Archetypes) {
+                const size_t chunks = archetype->getChunkCount();
+                for (size_t chunk = 0; chunk < chunks; chunk++)
+                    eachInChunk(*archetype, chunk, fn);
+            }
+        }
+
+        // Calls fn(count, entities, Ts*...) once per chunk, for loops that want the raw columns.
+        template<typename Func>
+        void eachChunk(Func&& fn) const {
+            for (Archetype* archetype : *m_Archetypes) {
+                const size_t chunks = archetype->getChunkCount();
+                for (size_t chunk = 0; chunk < chunks; chunk++) {
+                    if (!accepts(*archetype, chunk)) continue;
+                    (markWrite<Ts>(*archetype, chunk), ...);
+                    fn(archetype->getChunkSize(chunk), archetype->getChunkEntities(chunk), archetype->template getColumn<std::remove_const_t<Ts>>(chunk)...);
+                }
+            }
+        }
+
+        // Entity count ignoring the changed/added filters.
+        size_t size() const {
+            size_t count = 0;
+            for (const Archetype* archetype : *m_Archetypes)
+                count += archetype->getSize();
+            return count;
+        }
+
+        bool empty() const { return size() == 0; }
+
+        const std::vector<Archetype*>& getArchetypes() const { return *m_Archetypes; }
+
+        // Runs fn over a single chunk; lets callers split a view's chunks across threads.
+        template<typename Func>
+        void eachInChunk(Archetype& archetype, size_t chunk, Func& fn) const {
+            if (!accepts(archetype, chunk)) return;
+            (markWrite<Ts>(archetype, chunk), ...);
+
+            const size_t count = archetype.getChunkSize(chunk);
+            const EntityHandle* entities = archetype.getChunkEntities(chunk);
+            std::tuple<Ts*...> columns{ archetype.template getColumn<std::remove_const_t<Ts>>(chunk)... };
+
+            for (size_t i = 0; i < count; i++) {
+                if constexpr (std::is_invocable_v<Func&, EntityHandle, Ts&...>)
+                    fn(entities[i], std::get<Ts*>(columns)[i]...);
+                else
+                    fn(std::get<Ts*>(columns)[i]...);
+            }
+        }
+
+        // True when the chunk passes every changed/added filter.
+        bool accepts(const Archetype& archetype, size_t chunk) const {
+            for (const Filter& filter : m_Filters) {
+                const Tick tick = filter.added ? archetype.getAddedTick(filter.id, chunk) : archetype.getChangedTick(filter.id, chunk);
+                if (tick <= filter.since)
+                    return false;
+            }
+            return true;
+        }
+
+    private:
+        struct Filter {
+            ComponentId id;
+            Tick        since;
+            bool        added;
+        };
+
+        const std::vector<Archetype*>* m_Archetypes;
+        std::vector<Filter>            m_Filters;
+
+        template<typename T>
+        static void markWrite(Archetype& archetype, size_t chunk) {
+            if constexpr (!std::is_const_v<T>)
+                archetype.markChanged(getComponentId<T>(), chunk);
+        }
+    };
+
+} // namespace lgt
@@ -0,0 +1,194 @@
+#include "JobSystem.h"
+
+#include <memory>
+
+namespace lgt {
+
+    // Which queue the current thread owns. Threads that are neither workers nor the
+    // owner share queue 0, which is safe since every queue has its own mutex.
+    struct ThreadSlot {
+        const JobSystem* owner = nullptr;
+        size_t           index = 0;
+    };
+    static thread_local ThreadSlot t_Slot;
+
+    JobSystem::JobSystem(unsigned workerCount)
+    {
+        for (unsigned i = 0; i <= workerCount; i++)
+            m_Queues.push_back(std::make_unique<WorkQueue>());
+
+        t_Slot = { this, 0 };
+        for (unsigned i = 0; i < workerCount; i++)
+            m_Threads.emplace_back(&JobSystem::workerLoop, this, static_cast<size_t>(i + 1));
+    }
+
+    JobSystem::~JobSystem()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_SleepMutex);
+            m_Stop = true;
+        }
+        m_Wake.notify_all();
+        for (auto& thread : m_Threads)
+            thread.join();
+
+        if (t_Slot.owner == this)
+            t_Slot = {};
+    }
+
+    JobSystem& JobSystem::get()
+    {
+        static JobSystem instance;
+        return instance;
+    }
+
+    unsigned JobSystem::defaultWorkerCount()
+    {
+        const unsigned cores = std::thread::hardware_concurrency();
+        return cores > 1 ? cores - 1 : 0; // the owning thread helps while it waits
+    }
+
+    size_t JobSystem::localQueue() const
+    {
+        return t_Slot.owner == this ? t_Slot.index : 0;
+    }
+
+    void JobSystem::run(Job job, JobCounter* counter)
+    {
+        if (counter)
+            counter->m_Value.fetch_add(1, std::memory_order_relaxed);
+        push({ std::move(job), counter });
+    }
+
+    void JobSystem::runAfter(std::span<JobCounter* const> dependencies, Job job, JobCounter* counter)
+    {
+        if (counter)
+            counter->m_Value.fetch_add(1, std::memory_order_relaxed);
+
+        // one extra reference held while continuations are attached, so the job can't
+        // start before the loop below is done with the dependency list
+        struct Pending {
+            std::atomic<size_t> remaining;
+            Job                 fn;
+            JobCounter*         counter;
+        };
+        auto pending = std::make_shared<Pending>();
+        pending->remaining = dependencies.size() + 1;
+        pending->fn = std::move(job);
+        pending->counter = counter;
+
+        auto release = [this, pending]() {
+            if (pending->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                push({ std::move(pending->fn), pending->counter });
+        };
+
+        for (JobCounter* dependency : dependencies) {
+            std::unique_lock<std::mutex> lock(dependency->m_Mutex);
+            if (dependency->isDone()) {
+                lock.unlock();
+                release();
+            }
+            else {
+                dependency->m_Continuations.push_back(release);
+            }
+        }
+        release();
+    }
+
+    void JobSystem::wait(JobCounter& counter)
+    {
+        while (!counter.isDone()) {
+            if (!tryRunOne())
+                std::this_thread::yield();
+        }
+        // the last finish() may still hold the mutex; the counter must outlive it
+        std::lock_guard<std::mutex> lock(counter.m_Mutex);
+    }
+
+    void JobSystem::push(QueuedJob job)
+    {
+        WorkQueue& queue = *m_Queues[localQueue()];
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.jobs.push_back(std::move(job));
+        }
+        m_Pending.fetch_add(1, std::memory_order_release);
+        {
+            // taking the sleep mutex orders this against a worker checking m_Pending
+            std::lock_guard<std::mutex> lock(m_SleepMutex);
+        }
+        m_Wake.notify_one();
+    }
+
+    // Pops from the back of our own queue, else steals from the front of another.
+    bool JobSystem::tryRunOne()
+    {
+        const size_t self = localQueue();
+        const size_t count = m_Queues.size();
+        QueuedJob job;
+        bool found = false;
+
+        for (size_t i = 0; i < count && !found; i++) {
+            const size_t index = (self + i) % count;
+            WorkQueue& queue = *m_Queues[index];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.jobs.empty())
+                continue;
+
+            if (index == self) {
+                job = std::move(queue.jobs.back());
+                queue.jobs.pop_back();
+            }
+            else {
+                job = std::move(queue.jobs.front());
+                queue.jobs.pop_front();
+            }
+            found = true;
+        }
+
+        if (!found)
+            return false;
+
+        m_Pending.fetch_sub(1, std::memory_order_relaxed);
+        job.fn();
+        finish(job.counter);
+        return true;
+    }
+
+    void JobSystem::finish(JobCounter* counter)
+    {
+        if (!counter)
+            return;
+
+        // not the last job : nobody can be released yet, skip the lock
+        int value = counter->m_Value.load(std::memory_order_relaxed);
+        while (value > 1) {
+            if (counter->m_Value.compare_exchange_weak(value, value - 1, std::memory_order_acq_rel))
+                return;
+        }
+
+        std::vector<Job> continuations;
+        {
+            std::lock_guard<std::mutex> lock(counter->m_Mutex);
+            if (counter->m_Value.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                continuations.swap(counter->m_Continuations);
+        }
+        for (auto& continuation : continuations)
+            continuation();
+    }
+
+    void JobSystem::workerLoop(size_t index)
+    {
+        t_Slot = { this, index };
+        while (true) {
+            if (tryRunOne())
+                continue;
+
+            std::unique_lock<std::mutex> lock(m_SleepMutex);
+            m_Wake.wait(lock, [this] { return m_Stop || m_Pending.load(std::memory_order_acquire) > 0; });
+            if (m_Stop && m_Pending.load(std::memory_order_acquire) == 0)
+                return;
+        }
+    }
+
+} // namespace lgt
@@ -0,0 +1,107 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace lgt {
+
+    using Job = std::function<void()>;
+
+    // Counts unfinished jobs. Jobs queued with runAfter() start once it drops to zero.
+    class JobCounter {
+    public:
+        JobCounter() = default;
+        JobCounter(const JobCounter&) = delete;
+        JobCounter& operator=(const JobCounter&) = delete;
+
+        bool isDone() const { return m_Value.load(std::memory_order_acquire) == 0; }
+
+    private:
+        friend class JobSystem;
+
+        std::atomic<int>  m_Value{ 0 };
+        std::mutex        m_Mutex;        // guards m_Continuations
+        std::vector<Job>  m_Continuations;
+    };
+
+    // Engine-wide work-stealing job system.
+    // Every worker owns a deque: it pushes/pops its own work at the back (LIFO, cache
+    // warm) and idle workers steal from the front of the others. Slot 0 belongs to
+    // the thread that created the system (the main thread), which runs jobs while it
+    // waits on a counter instead of blocking.
+    class JobSystem {
+    public:
+        explicit JobSystem(unsigned workerCount = defaultWorkerCount());
+        ~JobSystem();
+
+        JobSystem(const JobSystem&) = delete;
+        JobSystem& operator=(const JobSystem&) = delete;
+
+        // Shared instance used by the ECS scheduler, asset loading, culling...
+        static JobSystem& get();
+        static unsigned defaultWorkerCount();
+
+        void run(Job job, JobCounter* counter = nullptr);
+        // Runs job once every dependency counter has reached zero.
+        void runAfter(std::span<JobCounter* const> dependencies, Job job, JobCounter* counter = nullptr);
+        // Executes queued jobs on the calling thread until counter reaches zero.
+        void wait(JobCounter& counter);
+
+        // Splits [begin, end) into ranges of about grain items and runs fn(rangeBegin, rangeEnd)
+        // on the workers; returns when every range is done.
+        template<typename Func>
+        void parallelFor(size_t begin, size_t end, size_t grain, Func&& fn) {
+            if (begin >= end) return;
+            grain = grain ? grain : 1;
+            if (end - begin <= grain) {
+                fn(begin, end);
+                return;
+            }
+
+            JobCounter counter;
+            for (size_t rangeBegin = begin; rangeBegin < end; rangeBegin += grain) {
+                const size_t rangeEnd = (end - rangeBegin > grain) ? rangeBegin + grain : end;
+                run([&fn, rangeBegin, rangeEnd]() { fn(rangeBegin, rangeEnd); }, &counter);
+            }
+            wait(counter);
+        }
+
+        unsigned getWorkerCount() const { return static_cast<unsigned>(m_Threads.size()); }
+        // Index of the calling thread in [0, getThreadCount()); 0 for the owner and outside threads.
+        size_t getThreadIndex() const { return localQueue(); }
+        // Number of threads that execute jobs (workers + the owning thread).
+        unsigned getThreadCount() const { return getWorkerCount() + 1; }
+
+    private:
+        struct QueuedJob {
+            Job         fn;
+            JobCounter* counter; // decremented once fn returns, may be null
+        };
+
+        struct WorkQueue {
+            std::mutex            mutex;
+            std::deque<QueuedJob> jobs;
+        };
+
+        std::vector<std::unique_ptr<WorkQueue>> m_Queues; // one per thread, 0 = owner
+        std::vector<std::thread>                m_Threads;
+        std::atomic<size_t>                     m_Pending{ 0 };
+        std::mutex                              m_SleepMutex;
+        std::condition_variable                 m_Wake;
+        std::atomic<bool>                       m_Stop{ false };
+
+        size_t localQueue() const;
+        void   push(QueuedJob job);
+        bool   tryRunOne();
+        void   workerLoop(size_t index);
+        void   finish(JobCounter* counter);
+    };
+
+} // namespace lgt
@@ -41,6 +41,7 @@ testModel::testModel() : m_speed(0.030f)
         m_shadowdebugbuffer = std::make_unique<FrameBuffer>(SHADOW_WIDTH,SHADOW_HEIGHT);
         m_colorbuffer = std::make_unique<FrameBuffer>(800,800);
         m_depthbuffer = std::make_unique<DepthBuffer>();
+        m_culling = std::make_unique<GpuCulling>();
     }
     catch (const std::exception& e) {
         LOG(LogLevel::_ERROR, "Failed to initialize model or shader: " + std::string(e.what()));
@@ -65,6 +66,10 @@ testModel::~testModel()
 void testModel::onRender()
 {
     m_render->Clear(); //clear main(default freambuffer first)
+    if (m_model) {
+        m_model->getRenderQueue().resetStats(); // the shadow and color passes add up to one frame
+    }
+    GLState::get().resetStats();
     
     renderShadowPass();
     renderColorPass();
@@ -116,16 +121,25 @@ void testModel::renderColorPass()
         m_colorshader->setVec3("u_color", m_renderingSettings.solidColor);
     }
 
+    const bool culling = m_culling && m_renderingSettings.gpuCulling;
+    m_model->getRenderQueue().setCulling(culling ? m_culling.get() : nullptr,
+        m_camera->GetProjectionMatrix() * m_camera->GetViewMatrix(), m_renderingSettings.occlusionCulling);
+
     m_model->Render(*m_colorshader);
     m_grid->render(*m_camera, m_deltaTime);
     m_colorbuffer->Unuse();
+
+    // next frame's occlusion test runs against this frame's depth
+    if (culling && m_renderingSettings.occlusionCulling) {
+        m_culling->buildHiZ(m_colorbuffer->GetDepthTextureId(), static_cast<int>(m_sceneSize.x), static_cast<int>(m_sceneSize.y));
+    }
 }
 
 void testModel::renderShadowPass() {
 
     m_depthbuffer->Use();
     glClear(GL_DEPTH_BUFFER_BIT);
-    glCullFace(GL_FRONT);
+    GLState::get().cullFace(GL_FRONT);
   
     m_depthshader->use();
 
@@ -133,11 +147,15 @@ void testModel::renderShadowPass() {
     m_depthshader->setMat4("u_view", m_shadowcam->GetViewMatrix());
     m_depthshader->setMat4("u_projection", m_shadowcam->GetProjectionMatrix());
 
+    // the Hi-Z pyramid is the main camera's, the shadow pass only culls against its frustum
+    m_model->getRenderQueue().setCulling(m_culling && m_renderingSettings.gpuCulling ? m_culling.get() : nullptr,
+        m_shadowcam->GetProjectionMatrix() * m_shadowcam->GetViewMatrix(), false);
+
     m_model->Render(*m_depthshader);
 
     m_depthshader->unuse();
     m_depthbuffer->Unsue();
-    glCullFace(GL_BACK);
+    GLState::get().cullFace(GL_BACK);
 }
 
 void testModel::renderShadowDebugPass()
@@ -180,6 +198,11 @@ void testModel::onUpdate(GLFWwindow* window)
     m_shadowcam->Update(m_lightSettings.position , m_lightSettings.direction);
     updateModelMatrix();
 
+    // ECS systems (transform, culling, ...) run on the scene's worker pool
+    if (m_scene) {
+        m_scene->Update(m_deltaTime);
+    }
+
     //temp code for input
 
     if (glfwGetKey(m_window, GLFW_KEY_P) == GLFW_PRESS && m_timestep > 0.56f) {
@@ -228,6 +251,7 @@ void testModel::onImguiRender()
     renderPerformancePanel();
     ImGui::Render();
     ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    GLState::get().invalidate(); // the ImGui backend sets GL state behind the shadow copy
 }
 
 void testModel::createDockSpace()
@@ -417,6 +441,11 @@ void testModel::renderMaterialTab()
         if (m_renderingSettings.useColor) {
             ImGui::ColorEdit3("Color", &m_renderingSettings.solidColor[0]);
         }
+
+        ImGui::Checkbox("GPU Culling", &m_renderingSettings.gpuCulling);
+        if (m_renderingSettings.gpuCulling) {
+            ImGui::Checkbox("Occlusion (Hi-Z)", &m_renderingSettings.occlusionCulling);
+        }
     }
 
     // Material properties
@@ -635,6 +664,84 @@ void testModel::renderPerformancePanel()
         ImGui::ShowDemoWindow(&showDemoWindow);
     }
 
+    // Render queue : draws issued this frame and the binds the key sort made redundant
+    if (m_model && ImGui::CollapsingHeader("Render Queue")) {
+        const RenderQueue::Stats& queue = m_model->getRenderQueue().getStats();
+        ImGui::Text("Draws: %zu for %zu meshes (sort %.3f ms)", queue.draws, queue.instances, queue.sortMs);
+        ImGui::Text("Indirect commands: %zu", queue.indirectCommands);
+        if (m_culling && m_renderingSettings.gpuCulling) {
+            // reading the counter back stalls, fine for a debug panel
+            ImGui::Text("GPU culling: %zu tested, %u visible in the last pass", queue.gpuCulled, m_culling->readVisibleCount());
+        }
+        ImGui::Text("Programs: %zu bound, %zu avoided", queue.programBinds, queue.programBindsSaved);
+        ImGui::Text("Materials: %zu bound, %zu avoided", queue.materialBinds, queue.materialBindsSaved);
+        ImGui::Text("Textures: %zu bound, %zu avoided", queue.textureBinds, queue.textureBindsSaved);
+        ImGui::Text("VAOs: %zu bound, %zu avoided", queue.vaoBinds, queue.vaoBindsSaved);
+    }
+
+    // GL state : calls that reached the driver vs. calls the shadow copy filtered out
+    if (ImGui::CollapsingHeader("GL State")) {
+        GLState& state = GLState::get();
+        const GLState::Stats& stats = state.getStats();
+        bool validate = state.isValidating();
+        if (ImGui::Checkbox("Validate against glGet (slow)", &validate)) {
+            state.setValidation(validate);
+        }
+        if (validate) {
+            ImGui::Text("Mismatches: %zu", stats.mismatches);
+        }
+        ImGui::Columns(3, "glstate", false);
+        ImGui::TextDisabled("Call"); ImGui::NextColumn();
+        ImGui::TextDisabled("Issued"); ImGui::NextColumn();
+        ImGui::TextDisabled("Filtered"); ImGui::NextColumn();
+        for (int call = 0; call < GLState::CallCount; call++) {
+            ImGui::Text("%s", GLState::getCallName(GLState::Call(call))); ImGui::NextColumn();
+            ImGui::Text("%zu", stats.issued[call]); ImGui::NextColumn();
+            ImGui::Text("%zu", stats.filtered[call]); ImGui::NextColumn();
+        }
+        ImGui::Columns(1);
+    }
+
+    // ECS memory : totals, a compaction button and one tree node per archetype
+    if (m_scene && ImGui::CollapsingHeader("ECS Memory")) {
+        lgt::Roster& roster = m_scene->getRoster();
+        const lgt::MemoryStats stats = roster.getMemoryStats();
+
+        ImGui::Text("Entities: %zu in %zu archetypes (%zu empty)", stats.entities, stats.archetypes, stats.emptyArchetypes);
+        ImGui::Text("Chunks: %zu", stats.chunks);
+        ImGui::Text("Components: %.1f KB used / %.1f KB reserved", stats.bytesUsed / 1024.0f, stats.bytesReserved / 1024.0f);
+        ImGui::Text("Entity index: %.1f KB", stats.indexBytes / 1024.0f);
+        ImGui::ProgressBar(stats.occupancy(), ImVec2(-1, 0), "occupancy");
+
+        static size_t lastReleased = 0;
+        if (ImGui::Button("Compact", ImVec2(-1, 0))) {
+            lastReleased = roster.compact();
+        }
+        if (lastReleased > 0) {
+            ImGui::TextDisabled("Last compaction released %.1f KB", lastReleased / 1024.0f);
+        }
+
+        for (size_t i = 0; i < stats.perArchetype.size(); i++) {
+            const lgt::ArchetypeMemoryStats& archetype = stats.perArchetype[i];
+            std::string label;
+            for (const lgt::ComponentMemoryStats& component : archetype.components) {
+                label += label.empty() ? "" : ", ";
+                label += component.name ? component.name : "#" + std::to_string(component.id);
+            }
+            if (label.empty()) label = "(no components)";
+
+            if (ImGui::TreeNode((void*)(intptr_t)i, "%s  [%zu]", label.c_str(), archetype.entities)) {
+                ImGui::Text("Chunks: %zu x %zu rows, %.0f%% occupied", archetype.chunks, archetype.chunkCapacity, archetype.occupancy() * 100.0f);
+                ImGui::Text("Bytes: %.1f KB used / %.1f KB reserved", archetype.bytesUsed / 1024.0f, archetype.bytesReserved / 1024.0f);
+                for (const lgt::ComponentMemoryStats& component : archetype.components) {
+                    ImGui::BulletText("%s : %.1f / %.1f KB", component.name ? component.name : ("#" + std::to_string(component.id)).c_str(),
+                        component.bytesUsed / 1024.0f, component.bytesReserved / 1024.0f);
+                }
+                ImGui::TreePop();
+            }
+        }
+    }
+
     ImGui::Separator();
     ImGui::TextDisabled("Enhanced PBR Renderer");
     ImGui::TextDisabled("OpenGL + ImGui");
@@ -5,6 +5,7 @@
 #include "Renderer/Model.h"
 #include "Test.h"
 #include "Renderer/Scene.h"
+#include "Renderer/GpuCulling.h"
 
 
 // Forward declarations
@@ -45,6 +46,8 @@ struct PhysicsSettings {
 struct RenderingSettings {
     bool useColor = true;
     glm::vec3 solidColor = glm::vec3(1.0f, 0.0f, 0.0f);
+    bool gpuCulling = true;
+    bool occlusionCulling = true; // Hi-Z from the previous frame's depth
 };
 
 struct PerformanceStats {
@@ -73,6 +76,7 @@ private:
     std::unique_ptr<shader> m_colorshader;
     std::unique_ptr<shader> m_depthshader;
     std::unique_ptr<shader> m_shadowdebugshader;
+    std::unique_ptr<GpuCulling> m_culling;
 
 
     // Transformation matrices